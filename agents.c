@@ -0,0 +1,101 @@
+#include "agents.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const int DIR_DX[] = {0, 0, 0, -1, 1};
+static const int DIR_DY[] = {0, -1, 1, 0, 0};
+
+// Whether moving the snake one step in `dir` keeps it alive this tick
+// (fruit is fine, walls, obstacles and snakes are not)
+static bool is_safe(const Game *game, const Snake *snake, Direction dir) {
+    int dx = DIR_DX[dir], dy = DIR_DY[dir];
+    if (dx == -snake->dx && dy == -snake->dy) return false; // Reversing is ignored
+
+    const Segment *head = snake_head(snake);
+    int x = head->x + dx, y = head->y + dy;
+    if (x < 0 || x >= game->width || y < 0 || y >= game->height) return false;
+
+    int cell = cell_index(game, x, y);
+    return !bitboard_test(&game->snakeCells, cell) &&
+           !bitboard_test(&game->obstacleCells, cell);
+}
+
+// Current heading as a Direction
+static Direction heading(const Snake *snake) {
+    if (snake->dx < 0) return DIR_LEFT;
+    if (snake->dx > 0) return DIR_RIGHT;
+    return snake->dy < 0 ? DIR_UP : DIR_DOWN;
+}
+
+// Any safe direction, starting the search at a random one
+static Direction any_safe(const Game *game, const Snake *snake, Rng *rng) {
+    int first = (int)rng_below(rng, 4);
+    for (int i = 0; i < 4; i++) {
+        Direction dir = (Direction)(DIR_UP + (first + i) % 4);
+        if (is_safe(game, snake, dir)) return dir;
+    }
+    return DIR_NONE; // Boxed in
+}
+
+// Keep going until something is in the way
+static Direction choose_straight(const Game *game, int index, Rng *rng) {
+    const Snake *snake = &game->snakes[index];
+    if (is_safe(game, snake, heading(snake))) return DIR_NONE;
+    return any_safe(game, snake, rng);
+}
+
+// Wander: turn now and then, never into something
+static Direction choose_random(const Game *game, int index, Rng *rng) {
+    const Snake *snake = &game->snakes[index];
+    if (rng_below(rng, 8) != 0 && is_safe(game, snake, heading(snake))) return DIR_NONE;
+    return any_safe(game, snake, rng);
+}
+
+// Head for the nearest fruit (by Manhattan distance) along a safe axis
+static Direction choose_greedy(const Game *game, int index, Rng *rng) {
+    const Snake *snake = &game->snakes[index];
+    const Segment *head = snake_head(snake);
+    const Food *target = NULL;
+    int best = 0;
+
+    for (int i = 0; i < game->foodCount; i++) {
+        const Food *food = &game->foods[i];
+        if (!food->active) continue;
+
+        int distance = abs(food->x - head->x) + abs(food->y - head->y);
+        if (!target || distance < best) {
+            target = food;
+            best = distance;
+        }
+    }
+
+    if (target) {
+        Direction horizontal = target->x < head->x ? DIR_LEFT : target->x > head->x ? DIR_RIGHT : DIR_NONE;
+        Direction vertical = target->y < head->y ? DIR_UP : target->y > head->y ? DIR_DOWN : DIR_NONE;
+
+        if (horizontal != DIR_NONE && is_safe(game, snake, horizontal)) return horizontal;
+        if (vertical != DIR_NONE && is_safe(game, snake, vertical)) return vertical;
+    }
+
+    return choose_straight(game, index, rng);
+}
+
+static const Agent AGENTS[] = {
+    {"straight", choose_straight},
+    {"random", choose_random},
+    {"greedy", choose_greedy},
+};
+
+#define AGENT_COUNT (int)(sizeof(AGENTS) / sizeof(AGENTS[0]))
+
+const Agent *find_agent(const char *name) {
+    for (int i = 0; i < AGENT_COUNT; i++) {
+        if (strcmp(AGENTS[i].name, name) == 0) return &AGENTS[i];
+    }
+    return NULL;
+}
+
+const char *agent_names(void) {
+    return "straight, random, greedy";
+}
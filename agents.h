@@ -0,0 +1,22 @@
+#ifndef AGENTS_H
+#define AGENTS_H
+
+#include "snake_sim.h"
+
+// Built-in players for headless matches. An agent looks at the game and
+// picks the next direction for one snake; it may draw on `rng` (private to
+// the match, so results only depend on the seed) but must not change the
+// game.
+typedef struct {
+    const char *name;
+    Direction (*choose)(const Game *game, int snake, Rng *rng);
+} Agent;
+
+// Look an agent up by name ("straight", "random" or "greedy"), NULL if
+// there is no such agent
+const Agent *find_agent(const char *name);
+
+// Comma-separated list of the agent names, for usage messages
+const char *agent_names(void);
+
+#endif
@@ -0,0 +1,228 @@
+#include "asset_pack.h"
+
+#include <SDL2/SDL_image.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define MAX_ATLAS_SIZE 16384
+
+// --- Mapping ---
+
+static bool map_file(AssetPack *pack, const char *path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    HANDLE mapping = NULL;
+    const void *data = NULL;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (!data) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    pack->file = file;
+    pack->mapping = mapping;
+    pack->data = data;
+    pack->size = (size_t)size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd); // The mapping keeps its own reference to the file
+    if (data == MAP_FAILED) return false;
+
+    pack->data = data;
+    pack->size = (size_t)info.st_size;
+#endif
+    return true;
+}
+
+static void unmap_file(AssetPack *pack) {
+#ifdef _WIN32
+    UnmapViewOfFile(pack->data);
+    CloseHandle(pack->mapping);
+    CloseHandle(pack->file);
+#else
+    munmap((void *)pack->data, pack->size);
+#endif
+}
+
+// --- Checking ---
+
+static bool in_file(const AssetPack *pack, size_t offset, size_t size) {
+    return offset <= pack->size && size <= pack->size - offset;
+}
+
+static bool check_entry(const AssetPack *pack, const PackEntry *entry) {
+    const PackHeader *header = pack->header;
+
+    if (!memchr(entry->name, '\0', ASSET_NAME_LENGTH)) return false;
+
+    switch (entry->type) {
+        case ASSET_SPRITE:
+            return entry->x >= 0 && entry->y >= 0 && entry->w > 0 && entry->h > 0 &&
+                   (uint32_t)entry->x + (uint32_t)entry->w <= header->atlasWidth &&
+                   (uint32_t)entry->y + (uint32_t)entry->h <= header->atlasHeight;
+        case ASSET_SOUND:
+            return entry->size >= WAV_HEADER_SIZE && entry->offset % 2 == 0 &&
+                   in_file(pack, entry->offset, entry->size);
+        case ASSET_FONT:
+            return in_file(pack, entry->offset, entry->size);
+        default:
+            return true; // From a newer packer; never looked up
+    }
+}
+
+static bool check_pack(const AssetPack *pack) {
+    const PackHeader *header = pack->header;
+
+    if (header->entryCount > (pack->size - sizeof(PackHeader)) / sizeof(PackEntry)) return false;
+    if (header->atlasWidth > MAX_ATLAS_SIZE || header->atlasHeight > MAX_ATLAS_SIZE) return false;
+    if (!in_file(pack, header->atlasOffset, (size_t)header->atlasWidth * header->atlasHeight * 4)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header->entryCount; i++) {
+        if (!check_entry(pack, &pack->entries[i])) return false;
+    }
+    return true;
+}
+
+bool open_asset_pack(AssetPack *pack, const char *path) {
+    memset(pack, 0, sizeof(AssetPack));
+    if (!map_file(pack, path)) return false;
+
+    pack->header = (const PackHeader *)pack->data;
+    pack->entries = (const PackEntry *)(pack->data + sizeof(PackHeader));
+
+    if (pack->size < sizeof(PackHeader) || pack->header->magic != ASSET_PACK_MAGIC ||
+        pack->header->version != ASSET_PACK_VERSION) {
+        printf("%s: not an asset pack, or from another version; using the loose files\n", path);
+        close_asset_pack(pack);
+        return false;
+    }
+    if (!check_pack(pack)) {
+        printf("%s: malformed asset pack; using the loose files\n", path);
+        close_asset_pack(pack);
+        return false;
+    }
+    return true;
+}
+
+void close_asset_pack(AssetPack *pack) {
+    if (pack->atlas) SDL_DestroyTexture(pack->atlas);
+    if (pack->data) unmap_file(pack);
+    memset(pack, 0, sizeof(AssetPack));
+}
+
+// --- Loading ---
+
+// The pack's entry of `type` for the file `path` names, or NULL
+static const PackEntry *find_entry(const AssetPack *pack, const char *path, AssetType type) {
+    if (!pack->data) return NULL;
+
+    const char *name = path;
+    for (const char *c = path; *c; c++) {
+        if (*c == '/' || *c == '\\') name = c + 1;
+    }
+
+    for (uint32_t i = 0; i < pack->header->entryCount; i++) {
+        const PackEntry *entry = &pack->entries[i];
+        if (entry->type == (uint32_t)type && strcmp(entry->name, name) == 0) return entry;
+    }
+    return NULL;
+}
+
+bool upload_pack_atlas(AssetPack *pack, SDL_Renderer *renderer) {
+    if (!pack->data || pack->header->atlasWidth == 0 || pack->header->atlasHeight == 0) return false;
+
+    const PackHeader *header = pack->header;
+    pack->atlas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC,
+                                    (int)header->atlasWidth, (int)header->atlasHeight);
+    if (!pack->atlas) return false;
+
+    if (SDL_UpdateTexture(pack->atlas, NULL, pack->data + header->atlasOffset,
+                          (int)header->atlasWidth * 4) != 0) {
+        SDL_DestroyTexture(pack->atlas);
+        pack->atlas = NULL;
+        return false;
+    }
+    SDL_SetTextureBlendMode(pack->atlas, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+bool load_sprite(const AssetPack *pack, SDL_Renderer *renderer, const char *path, Sprite *sprite) {
+    const PackEntry *entry = find_entry(pack, path, ASSET_SPRITE);
+    if (entry && pack->atlas) {
+        sprite->texture = pack->atlas;
+        sprite->source = (SDL_Rect){entry->x, entry->y, entry->w, entry->h};
+        sprite->owned = false;
+        return true;
+    }
+
+    sprite->texture = IMG_LoadTexture(renderer, path);
+    sprite->source = (SDL_Rect){0, 0, 0, 0};
+    sprite->owned = true;
+    if (!sprite->texture) return false;
+
+    SDL_QueryTexture(sprite->texture, NULL, NULL, &sprite->source.w, &sprite->source.h);
+    return true;
+}
+
+#ifndef SNAKE_HEADLESS
+Mix_Chunk *load_sound(const AssetPack *pack, const char *path) {
+    const PackEntry *entry = find_entry(pack, path, ASSET_SOUND);
+    if (!entry) return Mix_LoadWAV(path);
+
+    const unsigned char *wav = pack->data + entry->offset;
+    int frequency, channels;
+    Uint16 format;
+    const PackHeader *header = pack->header;
+
+    if (Mix_QuerySpec(&frequency, &format, &channels) &&
+        (uint32_t)frequency == header->soundFrequency && format == header->soundFormat &&
+        (uint32_t)channels == header->soundChannels) {
+        // Already in the mixer's format: play it from the mapping, which
+        // the mixer only ever reads
+        return Mix_QuickLoad_RAW((Uint8 *)wav + WAV_HEADER_SIZE, entry->size - WAV_HEADER_SIZE);
+    }
+
+    // The device gave us another format; let the mixer convert a copy
+    return Mix_LoadWAV_RW(SDL_RWFromConstMem(wav, (int)entry->size), 1);
+}
+#endif
+
+Font *load_font(const AssetPack *pack, SDL_Renderer *renderer, const char *path, int size, bool smooth) {
+    const PackEntry *entry = find_entry(pack, path, ASSET_FONT);
+    if (!entry) return open_font(renderer, path, size, smooth);
+
+    return open_font_rw(renderer, SDL_RWFromConstMem(pack->data + entry->offset, (int)entry->size),
+                        size, smooth);
+}
+
+void free_sprite(Sprite *sprite) {
+    if (sprite->owned && sprite->texture) SDL_DestroyTexture(sprite->texture);
+    sprite->texture = NULL;
+    sprite->owned = false;
+}
@@ -0,0 +1,105 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <SDL2/SDL.h>
+#ifndef SNAKE_HEADLESS
+#include <SDL2/SDL_mixer.h>
+#endif
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "text.h"
+
+// All of a game's assets in one file, built offline by pack_assets.c and
+// mapped into memory at startup. The sprites are decoded, scaled to the size
+// they are drawn at and packed into one RGBA atlas, so they reach the GPU in
+// a single texture upload with no PNG decoding. Sounds are stored as WAV
+// already converted to the mixer's format and are played straight from the
+// mapping; the font is the TTF file as is.
+//
+// File layout, little-endian, every section 16-byte aligned:
+//     PackHeader
+//     PackEntry[entryCount]
+//     atlas pixels       (SDL_PIXELFORMAT_RGBA32, atlasWidth * 4 bytes a row)
+//     sound and font data
+//
+// Assets are found by file name without the directory, so a front-end asks
+// for the path it would otherwise load and gets the loose file when there is
+// no pack or the pack doesn't have it.
+
+#define ASSET_PACK_FILE "assets.pak"
+#define ASSET_PACK_MAGIC 0x504b4e53u // "SNKP"
+#define ASSET_PACK_VERSION 1
+#define ASSET_NAME_LENGTH 32
+#define ASSET_ALIGNMENT 16
+
+// The format sounds are converted to, as the front-ends open the mixer
+#define PACK_SOUND_FREQUENCY 44100
+#define PACK_SOUND_FORMAT AUDIO_S16LSB
+#define PACK_SOUND_CHANNELS 2
+#define WAV_HEADER_SIZE 44
+
+typedef enum {
+    ASSET_SPRITE = 1,
+    ASSET_SOUND,
+    ASSET_FONT
+} AssetType;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t atlasWidth, atlasHeight;
+    uint32_t atlasOffset;
+    uint32_t soundFrequency; // Format of the PCM in every sound entry
+    uint32_t soundFormat;
+    uint32_t soundChannels;
+    uint32_t reserved[3];
+} PackHeader;
+
+typedef struct {
+    char name[ASSET_NAME_LENGTH]; // File name it was packed from, NUL-terminated
+    uint32_t type;                // AssetType
+    uint32_t offset, size;        // Sounds and fonts: the data in the file
+    int32_t x, y, w, h;           // Sprites: where they are in the atlas
+} PackEntry;
+
+typedef struct {
+    const unsigned char *data; // The mapped file, NULL if no pack is open
+    size_t size;
+    void *file, *mapping;      // Windows handles
+
+    const PackHeader *header;
+    const PackEntry *entries;
+    SDL_Texture *atlas;        // After upload_pack_atlas()
+} AssetPack;
+
+// A sprite to draw with queue_copy(queue, sprite.texture, &sprite.source, ...)
+typedef struct {
+    SDL_Texture *texture;
+    SDL_Rect source;
+    bool owned;  // Loaded from a loose file rather than the pack atlas
+} Sprite;
+
+// Map and check a pack. Prints a message and returns false if the file is
+// malformed or from another version; a missing file fails quietly. The pack
+// must stay open while anything loaded from it is in use.
+bool open_asset_pack(AssetPack *pack, const char *path);
+void close_asset_pack(AssetPack *pack);
+
+// Create the atlas texture for `renderer` in one upload from the mapping
+bool upload_pack_atlas(AssetPack *pack, SDL_Renderer *renderer);
+
+// Load from the pack if it is open and has the file, otherwise from `path`.
+// They fail as IMG_LoadTexture(), Mix_LoadWAV() and open_font() would.
+// Built with SNAKE_HEADLESS there is no load_sound().
+bool load_sprite(const AssetPack *pack, SDL_Renderer *renderer, const char *path, Sprite *sprite);
+#ifndef SNAKE_HEADLESS
+Mix_Chunk *load_sound(const AssetPack *pack, const char *path);
+#endif
+Font *load_font(const AssetPack *pack, SDL_Renderer *renderer, const char *path, int size, bool smooth);
+
+void free_sprite(Sprite *sprite);
+
+#endif
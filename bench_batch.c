@@ -0,0 +1,198 @@
+// Benchmark: many classic games stepped one Game at a time through
+// step_game() versus the structure-of-arrays batch in snake_batch.c.
+//
+// Build: gcc -O2 -mavx2 -o bench_batch bench_batch.c snake_batch.c snake_sim.c
+//        (-msse4.1 for the SSE kernel, neither for plain C)
+// Usage: bench_batch [games] [ticks]
+//
+// Every run sees the same turn pattern and restarts games as they die. The
+// vector kernel is first checked against the scalar reference kernel: both
+// must leave the batch in exactly the same state.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "snake_batch.h"
+
+#define DEFAULT_GAMES 4096
+#define DEFAULT_TICKS 2000
+#define INPUT_TICKS 64 // Turn pattern repeats after this many ticks
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Random turns, about one every eight ticks, from a private generator so
+// the fruit placement sequence is left alone
+static Direction *make_inputs(int games) {
+    Direction *inputs = malloc(sizeof(Direction) * games * INPUT_TICKS);
+    if (!inputs) return NULL;
+
+    unsigned state = 12345;
+    for (int i = 0; i < games * INPUT_TICKS; i++) {
+        state = state * 1103515245 + 12345;
+        unsigned r = state >> 16;
+        inputs[i] = r % 8 == 0 ? (Direction)(DIR_UP + (r >> 3) % 4) : DIR_NONE;
+    }
+    return inputs;
+}
+
+typedef void (*BatchStep)(SnakeBatch *batch, const Direction *input);
+
+typedef struct {
+    double seconds;
+    long games;
+    long long score;
+} RunStats;
+
+static void restart_dead(SnakeBatch *batch, RunStats *stats) {
+    for (int i = 0; i < batch->count; i++) {
+        if (batch->events[i] & EVENT_DIED) {
+            stats->score += batch->score[i];
+            stats->games++;
+            reset_batch_game(batch, i);
+        }
+    }
+}
+
+static RunStats run_batch(SnakeBatch *batch, BatchStep step, const Direction *inputs, int ticks) {
+    RunStats stats = {0};
+
+    double start = now_seconds();
+    for (int t = 0; t < ticks; t++) {
+        step(batch, &inputs[(t % INPUT_TICKS) * batch->count]);
+        restart_dead(batch, &stats);
+    }
+    stats.seconds = now_seconds() - start;
+    return stats;
+}
+
+static RunStats run_games(Game *games, int count, const Direction *inputs, int ticks) {
+    RunStats stats = {0};
+
+    double start = now_seconds();
+    for (int t = 0; t < ticks; t++) {
+        const Direction *input = &inputs[(t % INPUT_TICKS) * count];
+
+        for (int i = 0; i < count; i++) {
+            GameInput game_input = {{input[i], DIR_NONE}};
+            GameEvents events = step_game(&games[i], &game_input);
+
+            if (events.flags & EVENT_GAME_OVER) {
+                stats.score += games[i].snakes[0].score;
+                stats.games++;
+                reset_game(&games[i]);
+            }
+        }
+    }
+    stats.seconds = now_seconds() - start;
+    return stats;
+}
+
+static void report(const char *name, RunStats stats, int games, int ticks, double baseline) {
+    double rate = (double)games * ticks / stats.seconds;
+    printf("%-16s %8.3f s %14.0f ticks/sec %6.1fx %8ld games (avg score %.1f)\n",
+           name, stats.seconds, rate, baseline > 0 ? rate / baseline : 1.0,
+           stats.games, stats.games ? (double)stats.score / stats.games : 0.0);
+}
+
+// Run the scalar and vector kernels side by side and compare every array
+static bool check_kernels(const Direction *inputs, int games, int ticks) {
+    SnakeBatch *a = create_batch(games, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT, 1);
+    SnakeBatch *b = create_batch(games, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT, 1);
+    bool ok = a && b;
+
+    for (int t = 0; ok && t < ticks; t++) {
+        RunStats ignored = {0};
+        const Direction *input = &inputs[(t % INPUT_TICKS) * games];
+
+        step_batch_scalar(a, input);
+        restart_dead(a, &ignored);
+
+        step_batch(b, input);
+        restart_dead(b, &ignored);
+
+        size_t lane_bytes = (size_t)a->lanes * sizeof(int32_t);
+        ok = memcmp(a->headX, b->headX, lane_bytes) == 0 &&
+             memcmp(a->headY, b->headY, lane_bytes) == 0 &&
+             memcmp(a->length, b->length, lane_bytes) == 0 &&
+             memcmp(a->alive, b->alive, lane_bytes) == 0 &&
+             memcmp(a->foodX, b->foodX, lane_bytes) == 0 &&
+             memcmp(a->foodY, b->foodY, lane_bytes) == 0 &&
+             memcmp(a->score, b->score, lane_bytes) == 0 &&
+             memcmp(a->clock, b->clock, lane_bytes) == 0 &&
+             memcmp(a->events, b->events, lane_bytes) == 0 &&
+             memcmp(a->stamps, b->stamps, (size_t)a->lanes * a->cells * sizeof(int32_t)) == 0;
+        if (!ok) printf("kernel check: %s differs from scalar at tick %d\n", batch_kernel_name(), t);
+    }
+
+    if (ok) printf("kernel check: %s matches scalar over %d ticks\n\n", batch_kernel_name(), ticks);
+    free_batch(a);
+    free_batch(b);
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    int games = argc > 1 ? atoi(argv[1]) : DEFAULT_GAMES;
+    int ticks = argc > 2 ? atoi(argv[2]) : DEFAULT_TICKS;
+    if (games <= 0 || ticks <= 0) {
+        printf("Usage: %s [games] [ticks]\n", argv[0]);
+        return 1;
+    }
+
+    Direction *inputs = make_inputs(games);
+    if (!inputs) {
+        printf("Out of memory\n");
+        return 1;
+    }
+
+    if (!check_kernels(inputs, games, ticks < 1000 ? ticks : 1000)) return 1;
+
+    printf("%d games x %d ticks, %s kernel\n", games, ticks, batch_kernel_name());
+
+    // One Game per match through the regular simulation
+    Game *list = calloc(games, sizeof(Game));
+    if (!list) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    for (int i = 0; i < games; i++) {
+        if (!configure_game(&list[i], MODE_SINGLE, NULL, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT)) {
+            printf("Out of memory\n");
+            return 1;
+        }
+        seed_game(&list[i], i + 1);
+        reset_game(&list[i]);
+    }
+    RunStats scalar_games = run_games(list, games, inputs, ticks);
+    for (int i = 0; i < games; i++) {
+        free_game(&list[i]);
+    }
+    free(list);
+
+    double baseline = (double)games * ticks / scalar_games.seconds;
+    report("step_game loop", scalar_games, games, ticks, baseline);
+
+    SnakeBatch *batch = create_batch(games, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT, 1);
+    if (!batch) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    report("batch scalar", run_batch(batch, step_batch_scalar, inputs, ticks), games, ticks, baseline);
+    free_batch(batch);
+
+    batch = create_batch(games, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT, 1);
+    if (!batch) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    report("batch vector", run_batch(batch, step_batch, inputs, ticks), games, ticks, baseline);
+    free_batch(batch);
+
+    free(inputs);
+    return 0;
+}
@@ -0,0 +1,88 @@
+// Microbenchmark: snake movement with the old shift loop versus the
+// head-indexed circular buffer used by snake_sim.c.
+//
+// Build: gcc -O2 -o bench_body bench_body.c
+// Usage: bench_body
+//
+// Both variants move a body of the given length one cell per iteration and
+// read the tail back, so the work matches what move_snake() does per tick.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct {
+    int x, y;
+} Segment;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Previous implementation: shift every segment one slot towards the tail
+static long run_shift(Segment *body, int length, long moves) {
+    long checksum = 0;
+
+    for (long m = 0; m < moves; m++) {
+        for (int i = length - 1; i > 0; i--) {
+            body[i] = body[i - 1];
+        }
+        body[0].x = (body[0].x + 1) & 4095;
+
+        checksum += body[length - 1].x;
+    }
+    return checksum;
+}
+
+// Circular buffer: step the head index back and overwrite one slot
+static long run_ring(Segment *body, int length, long moves) {
+    long checksum = 0;
+    int head = 0;
+
+    for (long m = 0; m < moves; m++) {
+        int x = (body[head].x + 1) & 4095;
+        head = (head == 0 ? length : head) - 1;
+        body[head].x = x;
+
+        int tail = head + length - 1;
+        if (tail >= length) tail -= length;
+        checksum += body[tail].x;
+    }
+    return checksum;
+}
+
+int main(void) {
+    const int lengths[] = {10, 100, 1000, 10000, 100000};
+    const int count = sizeof(lengths) / sizeof(lengths[0]);
+
+    printf("%8s %14s %14s %10s\n", "length", "shift ns/move", "ring ns/move", "speedup");
+
+    for (int l = 0; l < count; l++) {
+        int length = lengths[l];
+        long moves = 200000000L / length;
+        if (moves < 2000) moves = 2000;
+        if (moves > 20000000) moves = 20000000;
+
+        Segment *body = calloc(length, sizeof(Segment));
+        if (!body) {
+            printf("Out of memory\n");
+            return 1;
+        }
+
+        double start = now_seconds();
+        long a = run_shift(body, length, moves);
+        double shift = (now_seconds() - start) / moves * 1e9;
+
+        start = now_seconds();
+        long b = run_ring(body, length, moves);
+        double ring = (now_seconds() - start) / moves * 1e9;
+
+        printf("%8d %14.2f %14.2f %9.1fx  (checksum %ld)\n",
+               length, shift, ring, shift / ring, a + b);
+        free(body);
+    }
+
+    return 0;
+}
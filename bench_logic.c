@@ -0,0 +1,497 @@
+// Microbenchmarks for the game-logic hot paths in snake_sim.c, with
+// results in JSON so two builds can be compared.
+//
+// Build: gcc -O2 -o bench_logic bench_logic.c snake_sim.c options.c -lm
+// Usage: bench_logic [--board WIDTHxHEIGHT] [--seed N] [--samples N] [output.json]
+//
+// Every case starts from a game seeded with --seed (1 by default), so two
+// runs do the same work. A case is timed in --samples samples (11 by
+// default) after one warm-up sample; each sample runs enough operations to
+// take at least MIN_SAMPLE_SECONDS, found by doubling before the warm-up.
+// The JSON file (bench_logic.json unless given) lists for every case the
+// mean, standard deviation, minimum and median ns per operation, and the
+// instructions per operation in the median sample where the kernel lets
+// us count them (Linux perf events; null elsewhere).
+//
+// Cases:
+//     move_snake        one move of a snake of the given length following a
+//                       cycle of a 128x128 board, so it never dies
+//     place_food        re-place one fruit, on a fresh board and on one 90%
+//                       covered by the snake
+//     place_obstacles   reset_game() of an obstacle game; the reset of a
+//                       game without them is timed next to it for the
+//                       difference, as obstacles are only taken off the
+//                       board by a reset
+//     move_obstacles,   every obstacle and MAX_FOODS fruits moving
+//     move_foods
+//     ensure_minimum_fruits  with both fruits in place, and after taking
+//                       both off the board
+//     step_game         full ticks of challenge mode for every combination
+//                       of features (chaos when all are on), plus single
+//                       and multi. Inputs are recorded first from a
+//                       fruit-chasing bot and replayed, so only the
+//                       simulation is timed; a match that ends is reset.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "options.h"
+#include "snake_sim.h"
+
+#define DEFAULT_SAMPLES 11
+#define MAX_SAMPLES 101
+#define MIN_SAMPLE_SECONDS 0.01
+#define DEFAULT_OUTPUT "bench_logic.json"
+#define SCRIPT_TICKS 100000 // Recorded inputs per step_game case
+#define LONG_BOARD 128      // Board side for the move_snake cases
+
+typedef struct {
+    char name[64];
+    long ops;                // Per sample
+    double mean, stddev, min, median; // ns per operation
+    double instructions;     // Per operation, negative when not counted
+} CaseResult;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// --- Instruction counter ---
+
+static int counter = -1;
+
+static void open_counter(void) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    counter = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+}
+
+static void start_counter(void) {
+#ifdef __linux__
+    if (counter < 0) return;
+    ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+    ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+}
+
+// Instructions since start_counter(), or -1 without a counter
+static double stop_counter(void) {
+#ifdef __linux__
+    uint64_t count;
+    if (counter < 0) return -1;
+    ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(counter, &count, sizeof(count)) != sizeof(count)) return -1;
+    return (double)count;
+#else
+    return -1;
+#endif
+}
+
+// --- Measurement ---
+
+static GameOptions options;
+static int sampleCount = DEFAULT_SAMPLES;
+static CaseResult results[128];
+static int resultCount;
+
+typedef void (*RunFunction)(Game *game, long ops);
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Time `run` on `game` and add the result under `name`
+static void measure(const char *name, Game *game, RunFunction run) {
+    CaseResult *result = &results[resultCount++];
+    snprintf(result->name, sizeof(result->name), "%s", name);
+
+    // Enough operations per sample to dwarf the clock; this also warms up
+    long ops = 1;
+    for (;;) {
+        double start = now_seconds();
+        run(game, ops);
+        if (now_seconds() - start >= MIN_SAMPLE_SECONDS) break;
+        ops *= 2;
+    }
+    run(game, ops);
+
+    double ns[MAX_SAMPLES], instructions[MAX_SAMPLES];
+    for (int s = 0; s < sampleCount; s++) {
+        start_counter();
+        double start = now_seconds();
+        run(game, ops);
+        double seconds = now_seconds() - start;
+        instructions[s] = stop_counter();
+        ns[s] = seconds / ops * 1e9;
+    }
+
+    double sum = 0, squares = 0;
+    for (int s = 0; s < sampleCount; s++) sum += ns[s];
+    result->mean = sum / sampleCount;
+    for (int s = 0; s < sampleCount; s++) squares += (ns[s] - result->mean) * (ns[s] - result->mean);
+    result->stddev = sampleCount > 1 ? sqrt(squares / (sampleCount - 1)) : 0;
+
+    // The instruction count of the sample whose time is the median
+    double sorted[MAX_SAMPLES];
+    memcpy(sorted, ns, sizeof(double) * sampleCount);
+    qsort(sorted, sampleCount, sizeof(double), compare_doubles);
+    result->min = sorted[0];
+    result->median = sorted[sampleCount / 2];
+    result->instructions = -1;
+    for (int s = 0; s < sampleCount; s++) {
+        if (ns[s] == result->median && instructions[s] >= 0) result->instructions = instructions[s] / ops;
+    }
+    result->ops = ops;
+
+    printf("%-50s %10.2f ns/op  +- %6.2f  (min %8.2f)", name, result->mean, result->stddev, result->min);
+    if (result->instructions >= 0) printf("  %8.1f instr/op", result->instructions);
+    printf("\n");
+}
+
+static bool write_json(const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        printf("%s: cannot write\n", path);
+        return false;
+    }
+
+    fprintf(file, "{\n  \"benchmark\": \"bench_logic\",\n");
+    fprintf(file, "  \"seed\": %llu,\n", (unsigned long long)(options.hasSeed ? options.seed : 1));
+    fprintf(file, "  \"board\": \"%dx%d\",\n", options.boardWidth, options.boardHeight);
+    fprintf(file, "  \"samples\": %d,\n", sampleCount);
+#ifdef __VERSION__
+    fprintf(file, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+    fprintf(file, "  \"cases\": [\n");
+    for (int i = 0; i < resultCount; i++) {
+        const CaseResult *result = &results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"ops_per_sample\": %ld, \"ns_per_op\": "
+                      "{\"mean\": %.3f, \"stddev\": %.3f, \"variance\": %.4f, \"min\": %.3f, \"median\": %.3f}, ",
+                result->name, result->ops, result->mean, result->stddev,
+                result->stddev * result->stddev, result->min, result->median);
+        if (result->instructions >= 0) {
+            fprintf(file, "\"instructions_per_op\": %.1f}", result->instructions);
+        } else {
+            fprintf(file, "\"instructions_per_op\": null}");
+        }
+        fprintf(file, "%s\n", i + 1 < resultCount ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    bool ok = fclose(file) == 0;
+    if (!ok) printf("%s: write failed\n", path);
+    return ok;
+}
+
+// --- Setup ---
+
+static uint64_t base_seed(void) {
+    return options.hasSeed ? options.seed : 1;
+}
+
+// Configure and reset a zeroed Game, bailing out if the arena can't be had
+static void start_game(Game *game, GameMode mode, const GameFeatures *features, int width, int height) {
+    if (!configure_game(game, mode, features, width, height)) {
+        printf("Out of memory\n");
+        exit(1);
+    }
+    seed_game(game, base_seed());
+    reset_game(game);
+}
+
+// Direction along a Hamiltonian cycle of the board (the height must be
+// even): serpentine rows from x = 1 and a return lane up column 0
+static Direction cycle_direction(const Game *game, int x, int y) {
+    if (x == 0) return y == 0 ? DIR_RIGHT : DIR_UP;
+    if (y % 2 == 0) return x < game->width - 1 ? DIR_RIGHT : DIR_DOWN;
+    if (x > 1) return DIR_LEFT;
+    return y == game->height - 1 ? DIR_LEFT : DIR_DOWN;
+}
+
+static void follow_cycle(Game *game) {
+    Snake *snake = &game->snakes[0];
+    turn_snake(snake, cycle_direction(game, snake_head(snake)->x, snake_head(snake)->y));
+    move_snake(game, 0);
+}
+
+// Grow the single player snake to `length` along the cycle, then run
+// another lap so the stacked tail segments unwind
+static void grow_along_cycle(Game *game, int length) {
+    Snake *snake = &game->snakes[0];
+
+    turn_snake(snake, DIR_DOWN);
+    move_snake(game, 0);
+    for (int t = 0; t < length + game->cells; t++) {
+        follow_cycle(game);
+        if (snake->length < length) grow_snake(snake);
+    }
+}
+
+static bool is_wall(const Game *game, int x, int y) {
+    return x < 0 || x >= game->width || y < 0 || y >= game->height;
+}
+
+// Head towards the first active fruit, turning away from walls
+static Direction choose_direction(const Game *game, int index) {
+    const Snake *snake = &game->snakes[index];
+    const Segment *head = snake_head(snake);
+    const Food *target = NULL;
+
+    for (int i = 0; i < game->foodCount; i++) {
+        if (game->foods[i].active) {
+            target = &game->foods[i];
+            break;
+        }
+    }
+
+    Direction want = DIR_NONE;
+    if (target) {
+        if (target->x < head->x && snake->dx != 1) want = DIR_LEFT;
+        else if (target->x > head->x && snake->dx != -1) want = DIR_RIGHT;
+        else if (target->y < head->y && snake->dy != 1) want = DIR_UP;
+        else if (target->y > head->y && snake->dy != -1) want = DIR_DOWN;
+    }
+    if (want != DIR_NONE) return want;
+
+    // Keep going unless that runs into a wall
+    if (!is_wall(game, head->x + snake->dx, head->y + snake->dy)) return DIR_NONE;
+    if (snake->dx != 0) return is_wall(game, head->x, head->y - 1) ? DIR_DOWN : DIR_UP;
+    return is_wall(game, head->x - 1, head->y) ? DIR_RIGHT : DIR_LEFT;
+}
+
+// --- Cases ---
+
+static void run_move_snake(Game *game, long ops) {
+    for (long i = 0; i < ops; i++) follow_cycle(game);
+}
+
+static void run_place_food(Game *game, long ops) {
+    for (long i = 0; i < ops; i++) place_food(game, &game->foods[0]);
+}
+
+static void run_reset(Game *game, long ops) {
+    for (long i = 0; i < ops; i++) reset_game(game);
+}
+
+static void run_move_obstacles(Game *game, long ops) {
+    for (long i = 0; i < ops; i++) move_obstacles(game);
+}
+
+static void run_move_foods(Game *game, long ops) {
+    for (long i = 0; i < ops; i++) move_foods(game);
+}
+
+static void run_ensure_steady(Game *game, long ops) {
+    for (long i = 0; i < ops; i++) ensure_minimum_fruits(game);
+}
+
+static void run_ensure_respawn(Game *game, long ops) {
+    for (long i = 0; i < ops; i++) {
+        for (int f = 0; f < game->foodCount; f++) remove_food(game, &game->foods[f]);
+        ensure_minimum_fruits(game);
+    }
+}
+
+// Inputs for the step_game cases, replayed in a loop
+static GameInput script[SCRIPT_TICKS];
+static long scriptNext;
+
+// Play SCRIPT_TICKS ticks with the bot from a fresh seed and keep the
+// inputs; replaying them from the same seed plays the same matches
+static void record_script(Game *game) {
+    seed_game(game, base_seed());
+    reset_game(game);
+    for (long t = 0; t < SCRIPT_TICKS; t++) {
+        for (int i = 0; i < MAX_SNAKES; i++) {
+            script[t].dir[i] = i < game->snakeCount ? choose_direction(game, i) : DIR_NONE;
+        }
+        step_game(game, &script[t]);
+        if (game->over) reset_game(game);
+    }
+
+    seed_game(game, base_seed());
+    reset_game(game);
+    scriptNext = 0;
+}
+
+static void run_step_game(Game *game, long ops) {
+    for (long i = 0; i < ops; i++) {
+        if (scriptNext == SCRIPT_TICKS) {
+            seed_game(game, base_seed());
+            reset_game(game);
+            scriptNext = 0;
+        }
+        step_game(game, &script[scriptNext++]);
+        if (game->over) reset_game(game);
+    }
+}
+
+static void bench_move_snake(void) {
+    const int lengths[] = {5, 50, 500, 5000, 15000};
+
+    for (int i = 0; i < (int)(sizeof(lengths) / sizeof(lengths[0])); i++) {
+        Game game = {0};
+        start_game(&game, MODE_SINGLE, NULL, LONG_BOARD, LONG_BOARD);
+        grow_along_cycle(&game, lengths[i]);
+
+        char name[64];
+        snprintf(name, sizeof(name), "move_snake/length=%d", lengths[i]);
+        measure(name, &game, run_move_snake);
+        free_game(&game);
+    }
+}
+
+static void bench_place_food(void) {
+    Game game = {0};
+    start_game(&game, MODE_SINGLE, NULL, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT);
+    measure("place_food/empty", &game, run_place_food);
+
+    grow_along_cycle(&game, game.cells * 9 / 10);
+    measure("place_food/90%-full", &game, run_place_food);
+    free_game(&game);
+}
+
+static void bench_obstacles(void) {
+    GameFeatures classic = {0};
+    GameFeatures obstacles = {0};
+    obstacles.obstacles = true;
+    GameFeatures chaos = {true, true, true, true, true, true};
+    Game game = {0};
+
+    start_game(&game, MODE_CHALLENGE, &classic, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT);
+    measure("reset_game/classic", &game, run_reset);
+    free_game(&game);
+
+    game = (Game){0};
+    start_game(&game, MODE_CHALLENGE, &obstacles, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT);
+    measure("place_obstacles (reset_game/obstacles)", &game, run_reset);
+    free_game(&game);
+
+    // Set every obstacle and MAX_FOODS fruits moving
+    game = (Game){0};
+    start_game(&game, MODE_CHALLENGE, &chaos, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT);
+    for (int i = 0; i < game.obstacleCount; i++) {
+        Obstacle *obstacle = &game.obstacles[i];
+        obstacle->moving = true;
+        if (obstacle->dx == 0 && obstacle->dy == 0) obstacle->dx = 1;
+    }
+    for (int i = 0; i < MAX_FOODS; i++) {
+        Food *food = &game.foods[i];
+        if (i >= game.foodCount) *food = (Food){0};
+        food->moving = true;
+        place_food(&game, food);
+    }
+    game.foodCount = MAX_FOODS;
+
+    char name[64];
+    snprintf(name, sizeof(name), "move_obstacles/count=%d", game.obstacleCount);
+    measure(name, &game, run_move_obstacles);
+    snprintf(name, sizeof(name), "move_foods/count=%d", game.foodCount);
+    measure(name, &game, run_move_foods);
+    free_game(&game);
+}
+
+static void bench_ensure_minimum_fruits(void) {
+    Game game = {0};
+    start_game(&game, MODE_MULTI, NULL, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT);
+    measure("ensure_minimum_fruits/steady", &game, run_ensure_steady);
+    measure("ensure_minimum_fruits/respawn-2", &game, run_ensure_respawn);
+    free_game(&game);
+}
+
+static void bench_step_game(void) {
+    const char *names[] = {"moving", "multi", "timed", "obstacles", "speed"};
+    Game game = {0};
+    char name[64];
+
+    start_game(&game, MODE_SINGLE, NULL, options.boardWidth, options.boardHeight);
+    record_script(&game);
+    measure("step_game/single", &game, run_step_game);
+    free_game(&game);
+
+    for (int combination = 0; combination < 32; combination++) {
+        GameFeatures features = {0};
+        features.movingFruit = combination & 1;
+        features.multiFruit = combination & 2;
+        features.timed = combination & 4;
+        features.obstacles = combination & 8;
+        features.speed = combination & 16;
+        features.chaos = combination == 31;
+
+        snprintf(name, sizeof(name), "step_game/challenge/");
+        if (combination == 0) strcat(name, "classic");
+        if (combination == 31) strcat(name, "chaos");
+        for (int f = 0; f < 5 && combination != 31; f++) {
+            if (!(combination & (1 << f))) continue;
+            if (name[strlen(name) - 1] != '/') strcat(name, "+");
+            strcat(name, names[f]);
+        }
+
+        game = (Game){0};
+        start_game(&game, MODE_CHALLENGE, &features, options.boardWidth, options.boardHeight);
+        record_script(&game);
+        measure(name, &game, run_step_game);
+        free_game(&game);
+    }
+
+    game = (Game){0};
+    start_game(&game, MODE_MULTI, NULL, options.boardWidth, options.boardHeight);
+    record_script(&game);
+    measure("step_game/multi", &game, run_step_game);
+    free_game(&game);
+}
+
+int main(int argc, char *argv[]) {
+    if (!parse_options(&options, &argc, argv)) return 1;
+
+    const char *output = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            sampleCount = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && !output) {
+            output = argv[i];
+        } else {
+            sampleCount = 0;
+            break;
+        }
+    }
+    if (sampleCount < 1 || sampleCount > MAX_SAMPLES) {
+        printf("Usage: %s [--board WIDTHxHEIGHT] [--seed N] [--samples N] [output.json]\n", argv[0]);
+        return 1;
+    }
+    if (!output) output = DEFAULT_OUTPUT;
+
+    open_counter();
+    if (counter < 0) printf("No instruction counter here; instructions_per_op will be null\n");
+
+    bench_move_snake();
+    bench_place_food();
+    bench_obstacles();
+    bench_ensure_minimum_fruits();
+    bench_step_game();
+
+    if (!write_json(output)) return 1;
+    printf("Wrote %s\n", output);
+    return 0;
+}
@@ -0,0 +1,266 @@
+// Benchmark: challenge mode's drawing on SDL's software renderer, as it
+// runs on machines without a GPU.
+//
+// Build: gcc -O2 -o bench_render bench_render.c agents.c asset_pack.c board_layer.c board_view.c
+//            headless.c host.c metrics.c options.c perf_hud.c render_queue.c replay.c
+//            snake_sim.c snake_sprites.c sound_queue.c text.c -lSDL2 -lSDL2_image -lSDL2_ttf -lSDL2_mixer
+// Usage: bench_render [frames]
+//
+// The draw functions are challenge.c's own: the file is included whole,
+// with SNAKE_LAUNCHER defined so it brings no main(). They draw into an
+// SDL_CreateSoftwareRenderer() surface the size of the window, on a fixed
+// scene of the default board: a 100-segment snake, 30 obstacles (every
+// other one moving) and 5 fruits, with the score and the timer changing
+// every frame as they do in play.
+//
+// Every frame is a clear, the draw and a present. The time to queue the
+// draw and the time the present takes to rasterize it are reported
+// separately, per function and then for whole frames as the game, the menu
+// and the game over screen draw them.
+
+#ifndef SNAKE_LAUNCHER
+#define SNAKE_LAUNCHER
+#endif
+#include "challenge.c"
+
+#define DEFAULT_FRAMES 5000
+#define WARMUP_FRAMES 50
+#define SNAKE_LENGTH 100
+#define FRUITS 5
+
+typedef struct {
+    Game game;
+    BoardView view;
+    BoardLayer layer;
+    SnakeSprites sprites;
+    Sprite apple, banana, grapes;
+    Font *font;
+    Button checkboxes[5];
+    Button chaosButton, playButton, exitButton, playAgainButton;
+} BenchScene;
+
+typedef void (*DrawFunction)(RenderQueue *queue, BenchScene *scene, int frame);
+
+// The snake along rows 2 to 5, head first, fruit and obstacles further down
+static bool build_scene(BenchScene *scene, SDL_Renderer *renderer) {
+    GameFeatures features = {0};
+    features.movingFruit = true;
+    features.multiFruit = true;
+    features.timed = true;
+    features.obstacles = true;
+
+    Game *game = &scene->game;
+    if (!configure_game(game, MODE_CHALLENGE, &features, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT)) {
+        printf("Out of memory\n");
+        return false;
+    }
+    seed_game(game, 1);
+    reset_game(game);
+
+    // Only the drawing looks at the scene, so the occupancy is left as is
+    Snake *snake = &game->snakes[0];
+    snake->head = 0;
+    snake->length = SNAKE_LENGTH;
+    for (int i = 0; i < SNAKE_LENGTH; i++) {
+        int row = i / (DEFAULT_GRID_WIDTH - 2);
+        int column = i % (DEFAULT_GRID_WIDTH - 2);
+        snake->body[i].x = (int16_t)(row % 2 == 0 ? DEFAULT_GRID_WIDTH - 2 - column : column + 1);
+        snake->body[i].y = (int16_t)(2 + row);
+    }
+    snake->dx = -1;
+    snake->dy = 0;
+
+    game->obstacleCount = MAX_OBSTACLES;
+    for (int i = 0; i < MAX_OBSTACLES; i++) {
+        Obstacle *obstacle = &game->obstacles[i];
+        obstacle->x = 1 + (i % 10) * 3;
+        obstacle->y = 9 + (i / 10) * 4;
+        obstacle->moving = i % 2 == 1;
+        obstacle->dx = 1;
+        obstacle->dy = 0;
+    }
+
+    game->foodCount = FRUITS;
+    for (int i = 0; i < FRUITS; i++) {
+        Food *food = &game->foods[i];
+        *food = (Food){0};
+        food->x = 4 + i * 6;
+        food->y = 20;
+        food->type = i % 4;
+        food->value = 1;
+        food->active = true;
+    }
+
+    update_board_view(&scene->view, game, 0, 0);
+
+    AssetPack loose = {0};
+    if (!load_sprite(&loose, renderer, "apple.png", &scene->apple) ||
+        !load_sprite(&loose, renderer, "banana.png", &scene->banana) ||
+        !load_sprite(&loose, renderer, "grapes.png", &scene->grapes)) {
+        printf("Failed to load fruit textures: %s\n", IMG_GetError());
+        return false;
+    }
+    scene->font = load_font(&loose, renderer, "dejavu-fonts-ttf-2.37/ttf/DejaVuSans.ttf", 24, true);
+    if (!scene->font) {
+        printf("TTF_OpenFont Error: %s\n", TTF_GetError());
+        return false;
+    }
+
+    // As run_challenge() lays them out, with two features ticked
+    const char *labels[5] = {"Moving Fruit", "Multi-Fruit", "Timed Mode", "Speed Mode", "Moving Obstacle"};
+    for (int i = 0; i < 5; i++) {
+        init_button(&scene->checkboxes[i], WINDOW_WIDTH / 2 - 100, 120 + i * 40, labels[i], true);
+    }
+    scene->checkboxes[0].checked = true;
+    scene->checkboxes[2].checked = true;
+    init_button(&scene->chaosButton, WINDOW_WIDTH / 2 - 100, 330, "CHAOS MODE (Everything!)", false);
+    init_button(&scene->playButton, WINDOW_WIDTH / 2 - 100, 400, "PLAY", false);
+    init_button(&scene->exitButton, WINDOW_WIDTH / 2 - 100, 450, "EXIT", false);
+    init_button(&scene->playAgainButton, WINDOW_WIDTH / 2 - 100, 400, "PLAY AGAIN", false);
+    return true;
+}
+
+static void free_scene(BenchScene *scene) {
+    close_font(scene->font);
+    free_sprite(&scene->apple);
+    free_sprite(&scene->banana);
+    free_sprite(&scene->grapes);
+    free_snake_sprites(&scene->sprites);
+    free_board_layer(&scene->layer);
+    free_game(&scene->game);
+}
+
+// Score and clock move on every frame
+static void advance(BenchScene *scene, int frame) {
+    scene->game.snakes[0].score = frame;
+    scene->game.elapsed = (unsigned)(frame * 16) % (unsigned)scene->game.timeLimit;
+}
+
+static void draw_cached_grid(RenderQueue *queue, BenchScene *scene, int frame) {
+    (void)frame;
+    draw_board_layer(queue, &scene->layer, &scene->view, &scene->game, NULL);
+}
+
+static void draw_rebuilt_grid(RenderQueue *queue, BenchScene *scene, int frame) {
+    (void)frame;
+    invalidate_board_layer(&scene->layer);
+    draw_board_layer(queue, &scene->layer, &scene->view, &scene->game, NULL);
+}
+
+static void draw_snake_only(RenderQueue *queue, BenchScene *scene, int frame) {
+    (void)frame;
+    draw_snake(queue, &scene->sprites, &scene->view, &scene->game.snakes[0]);
+}
+
+static void draw_fruit_only(RenderQueue *queue, BenchScene *scene, int frame) {
+    (void)frame;
+    for (int i = 0; i < scene->game.foodCount; i++) {
+        draw_food(queue, &scene->view, &scene->game.foods[i], &scene->apple, &scene->banana, &scene->grapes);
+    }
+}
+
+static void draw_obstacles_only(RenderQueue *queue, BenchScene *scene, int frame) {
+    (void)frame;
+    draw_obstacles(queue, &scene->view, &scene->game);
+}
+
+static void draw_ui_only(RenderQueue *queue, BenchScene *scene, int frame) {
+    advance(scene, frame);
+    draw_ui_area(queue, &scene->game, scene->font);
+}
+
+static void draw_menu_frame(RenderQueue *queue, BenchScene *scene, int frame) {
+    (void)frame;
+    draw_challenge_menu(queue, scene->checkboxes, 5, &scene->chaosButton, &scene->playButton,
+                        &scene->exitButton, scene->font);
+}
+
+// The final score stays put while the screen is up
+static void draw_game_over_frame(RenderQueue *queue, BenchScene *scene, int frame) {
+    (void)frame;
+    draw_game_over_screen(queue, 1234, &scene->playAgainButton, &scene->exitButton, scene->font);
+}
+
+static void draw_game_frame(RenderQueue *queue, BenchScene *scene, int frame) {
+    advance(scene, frame);
+    draw_board(queue, &scene->layer, &scene->view, &scene->game, &scene->apple, &scene->banana,
+               &scene->grapes, &scene->sprites);
+    draw_ui_area(queue, &scene->game, scene->font);
+}
+
+static void run(const char *name, RenderQueue *queue, BenchScene *scene, DrawFunction draw, int frames) {
+    double frequency = (double)SDL_GetPerformanceFrequency();
+    Uint64 clear = 0, queued = 0, presented = 0;
+    unsigned long calls = 0;
+
+    for (int frame = -WARMUP_FRAMES; frame < frames; frame++) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        set_queue_color(queue, 0, 0, 0, 255);
+        queue_clear(queue);
+        Uint64 cleared = SDL_GetPerformanceCounter();
+        draw(queue, scene, frame + WARMUP_FRAMES);
+        Uint64 drawn = SDL_GetPerformanceCounter();
+        present_render_queue(queue);
+        Uint64 end = SDL_GetPerformanceCounter();
+
+        if (frame < 0) continue;
+        clear += cleared - start;
+        queued += drawn - cleared;
+        presented += end - drawn;
+        calls += queue->frameCalls;
+    }
+
+    double scale = 1e6 / frequency / frames;
+    printf("%-24s %10.2f %10.2f %10.2f %10.2f %8.1f\n", name, queued * scale, presented * scale,
+           clear * scale, (clear + queued + presented) * scale, (double)calls / frames);
+}
+
+int main(int argc, char *argv[]) {
+    int frames = argc > 1 ? atoi(argv[1]) : DEFAULT_FRAMES;
+    if (frames <= 0) {
+        printf("Usage: %s [frames]\n", argv[0]);
+        return 1;
+    }
+
+    // No window: the software renderer draws into a plain surface
+    if (SDL_Init(0) < 0 || !(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) || TTF_Init() < 0) {
+        printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, WINDOW_WIDTH, WINDOW_HEIGHT, 32,
+                                                          SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer *renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    if (!renderer) {
+        printf("Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    RenderQueue queue;
+    init_render_queue(&queue, renderer);
+    BenchScene scene = {0};
+    if (!build_scene(&scene, renderer)) return 1;
+
+    printf("%d frames per run, software renderer, %dx%d, cell size %d\n",
+           frames, WINDOW_WIDTH, WINDOW_HEIGHT, scene.view.cellSize);
+    printf("%-24s %10s %10s %10s %10s %8s\n", "us/frame", "queue", "raster", "clear", "total", "calls");
+
+    run("draw_board_layer", &queue, &scene, draw_cached_grid, frames);
+    run("draw_board_layer rebuilt", &queue, &scene, draw_rebuilt_grid, frames);
+    run("draw_snake", &queue, &scene, draw_snake_only, frames);
+    run("draw_food x5", &queue, &scene, draw_fruit_only, frames);
+    run("draw_obstacles", &queue, &scene, draw_obstacles_only, frames);
+    run("draw_ui_area", &queue, &scene, draw_ui_only, frames);
+    run("draw_challenge_menu", &queue, &scene, draw_menu_frame, frames);
+    run("draw_game_over_screen", &queue, &scene, draw_game_over_frame, frames);
+    printf("\n");
+    run("game frame", &queue, &scene, draw_game_frame, frames);
+
+    free_scene(&scene);
+    free_render_queue(&queue);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    TTF_Quit();
+    IMG_Quit();
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,348 @@
+// Headless throughput benchmark for the simulation core.
+//
+// Build: gcc -O2 -o bench_sim bench_sim.c snake_sim.c options.c -lm
+// Usage: bench_sim [--board WIDTHxHEIGHT] [--seed N] [ticks per mode]
+//
+// Each mode is driven by a simple fruit-chasing bot and restarted whenever a
+// match ends, so the numbers include reset_game() and fruit placement.
+// A second pass times move_snake() alone at increasing snake lengths; with
+// the occupancy bitboards the cost per tick should not depend on length.
+//
+// Before timing anything it checks that place_food() only lands on free
+// cells and picks them uniformly (chi-square over many spawns on a fixed
+// board), that two games with the same seed and inputs stay identical
+// tick for tick, and that a game restored from a copy_game() snapshot plays
+// on exactly as it did the first time, and exits non-zero if not.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "snake_sim.h"
+#include "options.h"
+
+#define DEFAULT_TICKS 5000000
+#define SPAWN_SAMPLES 2000000
+#define REPLAY_TICKS 200000
+#define SNAPSHOT_TICKS 500  // Ticks played between saving a snapshot and restoring it
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool is_wall(const Game *game, int x, int y) {
+    return x < 0 || x >= game->width || y < 0 || y >= game->height;
+}
+
+// Head towards the first active fruit, turning away from walls
+static Direction choose_direction(const Game *game, int index) {
+    const Snake *snake = &game->snakes[index];
+    const Segment *head = snake_head(snake);
+    const Food *target = NULL;
+
+    for (int i = 0; i < game->foodCount; i++) {
+        if (game->foods[i].active) {
+            target = &game->foods[i];
+            break;
+        }
+    }
+
+    Direction want = DIR_NONE;
+    if (target) {
+        if (target->x < head->x && snake->dx != 1) want = DIR_LEFT;
+        else if (target->x > head->x && snake->dx != -1) want = DIR_RIGHT;
+        else if (target->y < head->y && snake->dy != 1) want = DIR_UP;
+        else if (target->y > head->y && snake->dy != -1) want = DIR_DOWN;
+    }
+    if (want != DIR_NONE) return want;
+
+    // Keep going unless that runs into a wall
+    if (!is_wall(game, head->x + snake->dx, head->y + snake->dy)) return DIR_NONE;
+    if (snake->dx != 0) return is_wall(game, head->x, head->y - 1) ? DIR_DOWN : DIR_UP;
+    return is_wall(game, head->x - 1, head->y) ? DIR_RIGHT : DIR_LEFT;
+}
+
+// Board size for the timed runs, from --board or the config file
+static GameOptions options;
+
+// Configure and reset a zeroed Game, bailing out if the arena can't be had
+static void start_game(Game *game, GameMode mode, const GameFeatures *features, int width, int height) {
+    if (!configure_game(game, mode, features, width, height)) {
+        printf("Out of memory\n");
+        exit(1);
+    }
+    seed_game(game, options.hasSeed ? options.seed : 1);
+    reset_game(game);
+}
+
+static void run_mode(const char *name, GameMode mode, const GameFeatures *features, long ticks) {
+    Game game = {0};
+    GameInput input = {{DIR_NONE, DIR_NONE}};
+    long games = 1;
+    long long score = 0;
+
+    start_game(&game, mode, features, options.boardWidth, options.boardHeight);
+
+    double start = now_seconds();
+    for (long t = 0; t < ticks; t++) {
+        for (int i = 0; i < game.snakeCount; i++) {
+            input.dir[i] = choose_direction(&game, i);
+        }
+
+        GameEvents events = step_game(&game, &input);
+        if (events.flags & EVENT_GAME_OVER) {
+            for (int i = 0; i < game.snakeCount; i++) {
+                score += game.snakes[i].score;
+            }
+            reset_game(&game);
+            games++;
+        }
+    }
+    double seconds = now_seconds() - start;
+
+    printf("%-10s %10ld ticks %8.3f s %12.0f ticks/sec %8ld games (avg score %.1f)\n",
+           name, ticks, seconds, ticks / seconds, games, (double)score / games);
+    free_game(&game);
+}
+
+// Direction along a Hamiltonian cycle of the board (the height must be
+// even): serpentine rows from x = 1 and a return lane up column 0
+static Direction cycle_direction(const Game *game, int x, int y) {
+    if (x == 0) return y == 0 ? DIR_RIGHT : DIR_UP;
+    if (y % 2 == 0) return x < game->width - 1 ? DIR_RIGHT : DIR_DOWN;
+    if (x > 1) return DIR_LEFT;
+    return y == game->height - 1 ? DIR_LEFT : DIR_DOWN;
+}
+
+static void run_length(int length, long ticks) {
+    Game game = {0};
+    start_game(&game, MODE_SINGLE, NULL, options.boardWidth, options.boardHeight);
+    Snake *snake = &game.snakes[0];
+
+    // Drop onto an even row, then follow the cycle while growing. Running
+    // one more lap lets the stacked tail segments unwind.
+    turn_snake(snake, DIR_DOWN);
+    move_snake(&game, 0);
+    for (int t = 0; t < length + game.cells; t++) {
+        turn_snake(snake, cycle_direction(&game, snake_head(snake)->x, snake_head(snake)->y));
+        move_snake(&game, 0);
+        if (snake->length < length) grow_snake(snake);
+    }
+
+    double start = now_seconds();
+    for (long t = 0; t < ticks; t++) {
+        turn_snake(snake, cycle_direction(&game, snake_head(snake)->x, snake_head(snake)->y));
+        move_snake(&game, 0);
+    }
+    double seconds = now_seconds() - start;
+
+    printf("length %-8d %10ld ticks %8.2f ns/tick%s\n",
+           snake->length, ticks, seconds / ticks * 1e9, snake->alive ? "" : " (died)");
+    free_game(&game);
+}
+
+// Spawn one fruit over and over on a default-size board with obstacles and
+// a snake, then compare the per-cell counts against a uniform distribution
+static bool check_spawn_uniformity(void) {
+    static long counts[DEFAULT_GRID_WIDTH * DEFAULT_GRID_HEIGHT];
+    GameFeatures features = {0};
+    features.obstacles = true;
+    Game game = {0};
+
+    start_game(&game, MODE_CHALLENGE, &features, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT);
+
+    Food *food = &game.foods[0];
+    remove_food(&game, food);
+    int free_cells = game.freeCount;
+
+    for (long i = 0; i < SPAWN_SAMPLES; i++) {
+        if (!place_food(&game, food)) {
+            printf("spawn: no free cell with %d free\n", game.freeCount);
+            free_game(&game);
+            return false;
+        }
+        if (bitboard_test(&game.snakeCells, cell_index(&game, food->x, food->y)) ||
+            bitboard_test(&game.obstacleCells, cell_index(&game, food->x, food->y))) {
+            printf("spawn: fruit placed on an occupied cell (%d, %d)\n", food->x, food->y);
+            free_game(&game);
+            return false;
+        }
+        counts[cell_index(&game, food->x, food->y)]++;
+    }
+    free_game(&game);
+
+    // Every free cell should have been hit, nothing else
+    double expected = (double)SPAWN_SAMPLES / free_cells;
+    double chi2 = 0;
+    int hit = 0;
+    for (int cell = 0; cell < (int)(sizeof(counts) / sizeof(counts[0])); cell++) {
+        if (counts[cell] == 0) continue;
+        double diff = counts[cell] - expected;
+        chi2 += diff * diff / expected;
+        hit++;
+    }
+
+    // Generous bound: mean of the distribution plus six standard deviations
+    int df = free_cells - 1;
+    double limit = df + 6 * sqrt(2.0 * df);
+    bool ok = hit == free_cells && chi2 < limit;
+
+    printf("spawn: %d free cells, %d hit, chi2 %.1f (limit %.1f) %s\n",
+           free_cells, hit, chi2, limit, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// FNV-1a over everything the rules and the random number generator decide
+static uint64_t hash_bytes(uint64_t hash, const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static uint64_t hash_game(const Game *game) {
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (int i = 0; i < game->snakeCount; i++) {
+        const Snake *snake = &game->snakes[i];
+        hash = hash_bytes(hash, &snake->length, sizeof(snake->length));
+        hash = hash_bytes(hash, &snake->score, sizeof(snake->score));
+        for (int s = 0; s < snake->length; s++) {
+            hash = hash_bytes(hash, snake_segment(snake, s), sizeof(Segment));
+        }
+    }
+    for (int i = 0; i < game->foodCount; i++) {
+        const Food *food = &game->foods[i];
+        int fields[] = {food->x, food->y, food->value, food->type, food->active};
+        hash = hash_bytes(hash, fields, sizeof(fields));
+    }
+    for (int i = 0; i < game->obstacleCount; i++) {
+        int fields[] = {game->obstacles[i].x, game->obstacles[i].y};
+        hash = hash_bytes(hash, fields, sizeof(fields));
+    }
+    return hash_bytes(hash, &game->rng, sizeof(game->rng));
+}
+
+// Play chaos mode, which uses every random choice the simulation makes,
+// match after match in one game, and replay each match in a freshly
+// configured game from the generator state it started with. The two must
+// agree after every tick.
+static bool check_replay(void) {
+    GameFeatures chaos = {true, true, true, true, true, true};
+    Game games[2] = {{0}, {0}};
+    GameInput input = {{DIR_NONE, DIR_NONE}};
+    bool ok = true;
+    long matches = 1;
+
+    for (int g = 0; g < 2; g++) {
+        start_game(&games[g], MODE_CHALLENGE, &chaos, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT);
+    }
+
+    long t = 0;
+    for (; ok && t < REPLAY_TICKS; t++) {
+        input.dir[0] = choose_direction(&games[0], 0);
+        step_game(&games[0], &input);
+        step_game(&games[1], &input);
+        ok = hash_game(&games[0]) == hash_game(&games[1]);
+
+        if (games[0].over) {
+            reset_game(&games[0]);
+
+            free_game(&games[1]);
+            games[1] = (Game){0};
+            start_game(&games[1], MODE_CHALLENGE, &chaos, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT);
+            games[1].rng = games[0].matchRng;
+            reset_game(&games[1]);
+            matches++;
+        }
+    }
+
+    printf("replay: %ld matches, %ld ticks %s\n", matches, t, ok ? "identical" : "DIVERGED");
+    free_game(&games[0]);
+    free_game(&games[1]);
+    return ok;
+}
+
+// Play chaos mode in stretches of SNAPSHOT_TICKS: save a snapshot, play on,
+// then restore it and play the same inputs again. The snapshot must not
+// have changed while the game went on, so the second run has to agree with
+// the first after every tick, restarts and fruit spawns included.
+static bool check_snapshots(void) {
+    GameFeatures chaos = {true, true, true, true, true, true};
+    Game game = {0}, snapshot = {0};
+    static Direction moves[SNAPSHOT_TICKS];
+    static uint64_t hashes[SNAPSHOT_TICKS];
+    GameInput input = {{DIR_NONE, DIR_NONE}};
+    bool ok = true;
+    long t = 0;
+
+    start_game(&game, MODE_CHALLENGE, &chaos, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT);
+    for (; ok && t < REPLAY_TICKS; t += SNAPSHOT_TICKS) {
+        if (!copy_game(&snapshot, &game)) {
+            printf("Could not allocate a snapshot\n");
+            return false;
+        }
+        for (int i = 0; i < SNAPSHOT_TICKS; i++) {
+            moves[i] = input.dir[0] = choose_direction(&game, 0);
+            step_game(&game, &input);
+            hashes[i] = hash_game(&game);
+            if (game.over) reset_game(&game);
+        }
+
+        if (!copy_game(&game, &snapshot)) {
+            printf("Could not restore a snapshot\n");
+            return false;
+        }
+        for (int i = 0; ok && i < SNAPSHOT_TICKS; i++) {
+            input.dir[0] = moves[i];
+            step_game(&game, &input);
+            ok = hash_game(&game) == hashes[i];
+            if (game.over) reset_game(&game);
+        }
+    }
+
+    printf("snapshots: %ld ticks %s\n", t, ok ? "identical" : "DIVERGED");
+    free_game(&game);
+    free_game(&snapshot);
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    if (!parse_options(&options, &argc, argv)) return 1;
+
+    long ticks = argc > 1 ? atol(argv[1]) : DEFAULT_TICKS;
+    if (ticks <= 0) {
+        printf("Usage: %s [--board WIDTHxHEIGHT] [--seed N] [ticks per mode]\n", argv[0]);
+        return 1;
+    }
+
+    if (!check_spawn_uniformity()) return 1;
+    if (!check_replay()) return 1;
+    if (!check_snapshots()) return 1;
+    printf("\n");
+
+    GameFeatures classic = {0};
+    GameFeatures chaos = {true, true, true, true, true, true};
+
+    run_mode("single", MODE_SINGLE, NULL, ticks);
+    run_mode("challenge", MODE_CHALLENGE, &classic, ticks);
+    run_mode("chaos", MODE_CHALLENGE, &chaos, ticks);
+    run_mode("multi", MODE_MULTI, NULL, ticks);
+
+    // The cycle the length runs follow needs an even number of rows
+    if (options.boardHeight % 2 != 0) return 0;
+
+    printf("\n");
+    const int lengths[] = {5, 10, 25, 50, 100, 200, 400, 700, 5000, 50000, 500000, 5000000};
+    for (int i = 0; i < (int)(sizeof(lengths) / sizeof(lengths[0])); i++) {
+        if (lengths[i] < options.boardWidth * (options.boardHeight - 1)) {
+            run_length(lengths[i], ticks);
+        }
+    }
+
+    return 0;
+}
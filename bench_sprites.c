@@ -0,0 +1,229 @@
+// Benchmark: snake body drawing with the old per-pixel drawCircle() versus
+// the pre-rasterized sprites in snake_sprites.c.
+//
+// Build: gcc -O2 -o bench_sprites bench_sprites.c snake_sprites.c render_queue.c board_view.c snake_sim.c -lSDL2
+// Usage: bench_sprites [frames]
+//
+// Snakes of several lengths are laid out in a serpentine on the default
+// board and drawn into a hidden window without vsync. Before timing, both
+// paths draw every length into a software renderer and must produce the
+// same pixels.
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board_view.h"
+#include "render_queue.h"
+#include "snake_sprites.h"
+
+#define DEFAULT_FRAMES 300
+#define WARMUP_FRAMES 10
+
+static const int LENGTHS[] = {5, 25, 100, 300, 700};
+#define LENGTH_COUNT (int)(sizeof(LENGTHS) / sizeof(LENGTHS[0]))
+
+static const SDL_Color BODY_COLOR = {0, 200, 0, 255};
+static const SDL_Color HEAD_COLOR = {0, 255, 0, 255};
+
+typedef struct {
+    long points;  // SDL_RenderDrawPoint calls, old path
+    long calls;   // Renderer calls through the queue, new path
+} DrawCounts;
+
+// The snake drawing the front-ends used before snake_sprites.c
+static void drawCircle(SDL_Renderer *renderer, int x, int y, int radius, DrawCounts *counts) {
+    for (int w = 0; w < radius * 2; w++) {
+        for (int h = 0; h < radius * 2; h++) {
+            int dx = radius - w;
+            int dy = radius - h;
+            if ((dx * dx + dy * dy) <= (radius * radius)) {
+                SDL_RenderDrawPoint(renderer, x + dx, y + dy);
+                counts->points++;
+            }
+        }
+    }
+}
+
+static void draw_snake_points(SDL_Renderer *renderer, const BoardView *view, const Snake *snake,
+                              DrawCounts *counts) {
+    int radius = view->cellSize / 2;
+
+    SDL_SetRenderDrawColor(renderer, BODY_COLOR.r, BODY_COLOR.g, BODY_COLOR.b, 255);
+    for (int i = 1; i < snake->length; i++) {
+        const Segment *segment = snake_segment(snake, i);
+        if (!view_contains(view, segment->x, segment->y)) continue;
+        drawCircle(renderer, view_screen_x(view, segment->x) + radius,
+                   view_screen_y(view, segment->y) + radius, radius, counts);
+    }
+
+    SDL_SetRenderDrawColor(renderer, HEAD_COLOR.r, HEAD_COLOR.g, HEAD_COLOR.b, 255);
+    const Segment *head = snake_head(snake);
+    if (!view_contains(view, head->x, head->y)) return;
+    int head_x = view_screen_x(view, head->x) + radius;
+    int head_y = view_screen_y(view, head->y) + radius;
+    drawCircle(renderer, head_x, head_y, radius, counts);
+
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    int eye_offset_x = radius / 2;
+    int eye_y = head_y - radius / 3;
+    int eye_radius = radius / 4;
+    drawCircle(renderer, head_x - eye_offset_x, eye_y, eye_radius, counts);
+    drawCircle(renderer, head_x + eye_offset_x, eye_y, eye_radius, counts);
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    drawCircle(renderer, head_x - eye_offset_x, eye_y, eye_radius / 2, counts);
+    drawCircle(renderer, head_x + eye_offset_x, eye_y, eye_radius / 2, counts);
+}
+
+// A snake of `length` segments snaking back and forth from the top-left
+static void make_snake(Snake *snake, Segment *body, int length) {
+    memset(snake, 0, sizeof(Snake));
+    snake->body = body;
+    snake->capacity = length;
+    snake->length = length;
+    snake->alive = true;
+
+    for (int i = 0; i < length; i++) {
+        int row = i / DEFAULT_GRID_WIDTH;
+        int col = i % DEFAULT_GRID_WIDTH;
+        body[i].x = row % 2 == 0 ? col : DEFAULT_GRID_WIDTH - 1 - col;
+        body[i].y = row;
+    }
+    // Head first
+    for (int i = 0; i < length / 2; i++) {
+        Segment swap = body[i];
+        body[i] = body[length - 1 - i];
+        body[length - 1 - i] = swap;
+    }
+}
+
+static void draw_frame(RenderQueue *queue, SnakeSprites *sprites, const BoardView *view,
+                       const Snake *snake, bool use_sprites, DrawCounts *counts) {
+    set_queue_color(queue, 0, 0, 0, 255);
+    queue_clear(queue);
+    if (use_sprites) {
+        draw_snake_sprites(queue, sprites, view, snake, BODY_COLOR, HEAD_COLOR);
+    } else {
+        draw_snake_points(queue->renderer, view, snake, counts);
+    }
+    present_render_queue(queue);
+    if (use_sprites) counts->calls += queue->frameCalls;
+}
+
+// Both paths into a software renderer, compared pixel by pixel
+static bool check_pixels(const BoardView *view, Snake *snake, Segment *body) {
+    SDL_Surface *surfaces[2];
+    bool ok = true;
+
+    for (int l = 0; ok && l < LENGTH_COUNT; l++) {
+        make_snake(snake, body, LENGTHS[l]);
+
+        for (int path = 0; path < 2; path++) {
+            surfaces[path] = SDL_CreateRGBSurfaceWithFormat(0, WINDOW_WIDTH, WINDOW_HEIGHT, 32,
+                                                            SDL_PIXELFORMAT_RGBA32);
+            SDL_Renderer *renderer = surfaces[path] ? SDL_CreateSoftwareRenderer(surfaces[path]) : NULL;
+            if (!renderer) {
+                printf("Software renderer could not be created! SDL_Error: %s\n", SDL_GetError());
+                return false;
+            }
+
+            RenderQueue queue;
+            init_render_queue(&queue, renderer);
+            SnakeSprites sprites = {0};
+            DrawCounts counts = {0};
+            draw_frame(&queue, &sprites, view, snake, path == 1, &counts);
+            free_snake_sprites(&sprites);
+            free_render_queue(&queue);
+            SDL_DestroyRenderer(renderer);
+        }
+
+        ok = memcmp(surfaces[0]->pixels, surfaces[1]->pixels,
+                    (size_t)surfaces[0]->pitch * WINDOW_HEIGHT) == 0;
+        if (!ok) printf("pixel check: sprites differ from drawCircle at length %d\n", LENGTHS[l]);
+
+        SDL_FreeSurface(surfaces[0]);
+        SDL_FreeSurface(surfaces[1]);
+    }
+
+    if (ok) printf("pixel check: sprites match drawCircle at cell size %d\n\n", view->cellSize);
+    return ok;
+}
+
+static double run(RenderQueue *queue, SnakeSprites *sprites, const BoardView *view,
+                  const Snake *snake, bool use_sprites, int frames, DrawCounts *counts) {
+    double frequency = (double)SDL_GetPerformanceFrequency();
+    Uint64 start = 0;
+
+    for (int frame = -WARMUP_FRAMES; frame < frames; frame++) {
+        if (frame == 0) {
+            memset(counts, 0, sizeof(DrawCounts));
+            start = SDL_GetPerformanceCounter();
+        }
+        draw_frame(queue, sprites, view, snake, use_sprites, counts);
+    }
+    return (SDL_GetPerformanceCounter() - start) * 1000.0 / frequency / frames;
+}
+
+int main(int argc, char *argv[]) {
+    int frames = argc > 1 ? atoi(argv[1]) : DEFAULT_FRAMES;
+    if (frames <= 0) {
+        printf("Usage: %s [frames]\n", argv[0]);
+        return 1;
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    Game game = {0};
+    game.width = DEFAULT_GRID_WIDTH;
+    game.height = DEFAULT_GRID_HEIGHT;
+    BoardView view;
+    update_board_view(&view, &game, 0, 0);
+
+    Snake snake;
+    Segment *body = malloc(sizeof(Segment) * LENGTHS[LENGTH_COUNT - 1]);
+    if (!body) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    if (!check_pixels(&view, &snake, body)) return 1;
+
+    SDL_Window *window = SDL_CreateWindow("bench_sprites", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                                          WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_HIDDEN);
+    SDL_Renderer *renderer = window ? SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED) : NULL;
+    if (!renderer) {
+        printf("Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_RendererInfo info;
+    SDL_GetRendererInfo(renderer, &info);
+    printf("%d frames per run, %s renderer, cell size %d\n", frames, info.name, view.cellSize);
+    printf("%-8s %14s %12s %14s %12s %8s\n", "length", "points ms/frm", "points/frm",
+           "sprites ms/frm", "calls/frm", "speedup");
+
+    RenderQueue queue;
+    init_render_queue(&queue, renderer);
+    SnakeSprites sprites = {0};
+    for (int l = 0; l < LENGTH_COUNT; l++) {
+        make_snake(&snake, body, LENGTHS[l]);
+
+        DrawCounts before, after;
+        double points_ms = run(&queue, &sprites, &view, &snake, false, frames, &before);
+        double sprites_ms = run(&queue, &sprites, &view, &snake, true, frames, &after);
+
+        printf("%-8d %14.3f %12ld %14.3f %12ld %7.1fx\n", LENGTHS[l], points_ms, before.points / frames,
+               sprites_ms, after.calls / frames, points_ms / sprites_ms);
+    }
+
+    free_snake_sprites(&sprites);
+    free_render_queue(&queue);
+    free(body);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,173 @@
+// Benchmark: frame time of the menu and HUD screens with the old
+// per-call SDL_ttf text path versus the glyph atlas and label cache in
+// text.c.
+//
+// Build: gcc -O2 -o bench_text bench_text.c text.c render_queue.c -lSDL2 -lSDL2_ttf
+// Usage: bench_text [frames] [font.ttf]
+//
+// Renders into a hidden window without vsync, so the numbers are CPU plus
+// driver cost per frame. The menu scene draws the same fixed strings every
+// frame; the HUD scene changes its score and timer every frame.
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "render_queue.h"
+#include "text.h"
+
+#define SCREEN_WIDTH 800
+#define SCREEN_HEIGHT 600
+#define DEFAULT_FRAMES 2000
+#define WARMUP_FRAMES 20
+#define DEFAULT_FONT "dejavu-fonts-ttf-2.37/ttf/DejaVuSans.ttf"
+
+typedef enum {
+    PATH_TTF,    // Render, upload and destroy every string every frame
+    PATH_ATLAS,  // draw_text()
+    PATH_LABELS  // draw_label(), falling back to the atlas when full
+} TextPath;
+
+static const char *PATH_NAMES[] = {"ttf per call", "atlas", "label cache"};
+
+static const char *MENU_LINES[] = {
+    "SNAKE GAME CHALLENGES",
+    "Moving Fruit", "Multi Fruit", "Timed Mode", "Obstacles", "Speed Up",
+    "CHAOS MODE", "PLAY", "EXIT"
+};
+#define MENU_LINE_COUNT (int)(sizeof(MENU_LINES) / sizeof(MENU_LINES[0]))
+
+// The text drawing the front-ends used before text.c, straight to the
+// renderer once whatever is queued underneath has been drawn
+static void draw_text_ttf(RenderQueue *queue, Font *font, const char *text, int x, int y, SDL_Color color) {
+    SDL_Renderer *renderer = queue->renderer;
+    flush_render_queue(queue);
+
+    SDL_Surface *surface = TTF_RenderText_Blended(font->ttf, text, color);
+    if (!surface) return;
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+
+    SDL_Rect rect = {x, y, surface->w, surface->h};
+    SDL_RenderCopy(renderer, texture, NULL, &rect);
+    queue->calls++;
+
+    SDL_FreeSurface(surface);
+    SDL_DestroyTexture(texture);
+}
+
+static void draw_with(TextPath path, RenderQueue *queue, Font *font, const char *text, int x, int y) {
+    SDL_Color white = {255, 255, 255, 255};
+    switch (path) {
+        case PATH_TTF: draw_text_ttf(queue, font, text, x, y, white); break;
+        case PATH_ATLAS: draw_text(queue, font, text, x, y, white); break;
+        case PATH_LABELS: draw_label(queue, font, text, x, y, white); break;
+    }
+}
+
+static void draw_menu(RenderQueue *queue, Font *font, TextPath path, int frame) {
+    (void)frame;
+    for (int i = 0; i < MENU_LINE_COUNT; i++) {
+        draw_with(path, queue, font, MENU_LINES[i], 200, 60 + i * 50);
+    }
+}
+
+static void draw_hud(RenderQueue *queue, Font *font, TextPath path, int frame) {
+    char text[32];
+
+    set_queue_layer(queue, LAYER_PANEL);
+    set_queue_color(queue, 30, 30, 40, 255);
+    SDL_Rect ui_rect = {0, 0, SCREEN_WIDTH, 40};
+    queue_fill_rect(queue, &ui_rect);
+
+    sprintf(text, "SCORE: %d", frame * 10);
+    draw_with(path, queue, font, text, 10, 10);
+    draw_with(path, queue, font, "OBSTACLES + SPEED", SCREEN_WIDTH / 2 - 100, 10);
+    sprintf(text, "TIME: %ds", 120 - frame % 120);
+    draw_with(path, queue, font, text, SCREEN_WIDTH - 150, 10);
+}
+
+typedef void (*Scene)(RenderQueue *queue, Font *font, TextPath path, int frame);
+
+static double run_scene(RenderQueue *queue, Font *font, Scene scene, TextPath path, int frames,
+                        double *worst) {
+    double frequency = (double)SDL_GetPerformanceFrequency();
+    double total = 0;
+    *worst = 0;
+
+    for (int frame = -WARMUP_FRAMES; frame < frames; frame++) {
+        Uint64 start = SDL_GetPerformanceCounter();
+
+        set_queue_color(queue, 0, 0, 0, 255);
+        queue_clear(queue);
+        scene(queue, font, path, frame < 0 ? 0 : frame);
+        present_render_queue(queue);
+
+        double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / frequency;
+        if (frame < 0) continue;
+        total += ms;
+        if (ms > *worst) *worst = ms;
+    }
+    return total / frames;
+}
+
+int main(int argc, char *argv[]) {
+    int frames = argc > 1 ? atoi(argv[1]) : DEFAULT_FRAMES;
+    const char *font_path = argc > 2 ? argv[2] : DEFAULT_FONT;
+    if (frames <= 0) {
+        printf("Usage: %s [frames] [font.ttf]\n", argv[0]);
+        return 1;
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0 || TTF_Init() < 0) {
+        printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_Window *window = SDL_CreateWindow("bench_text", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                                          SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_HIDDEN);
+    SDL_Renderer *renderer = window ? SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED) : NULL;
+    if (!renderer) {
+        printf("Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    RenderQueue queue;
+    init_render_queue(&queue, renderer);
+    Font *font = open_font(renderer, font_path, 24, true);
+    if (!font) {
+        printf("Failed to load %s! SDL_ttf Error: %s\n", font_path, TTF_GetError());
+        return 1;
+    }
+
+    SDL_RendererInfo info;
+    SDL_GetRendererInfo(renderer, &info);
+    printf("%d frames per run, %s renderer, %dx%d atlas\n\n",
+           frames, info.name, font->atlasWidth, font->atlasHeight);
+
+    const char *scene_names[] = {"menu", "hud"};
+    Scene scenes[] = {draw_menu, draw_hud};
+
+    for (int s = 0; s < 2; s++) {
+        double baseline = 0;
+        for (TextPath path = PATH_TTF; path <= PATH_LABELS; path++) {
+            unsigned misses = font->labelMisses;
+            double worst;
+            double average = run_scene(&queue, font, scenes[s], path, frames, &worst);
+            if (path == PATH_TTF) baseline = average;
+
+            printf("%-5s %-12s %8.3f ms/frame  worst %7.3f ms  %5.1fx  %3u calls/frame", scene_names[s],
+                   PATH_NAMES[path], average, worst, baseline / average, queue.frameCalls);
+            if (path == PATH_LABELS) printf("  (%u label renders)", font->labelMisses - misses);
+            printf("\n");
+        }
+        printf("\n");
+    }
+
+    close_font(font);
+    free_render_queue(&queue);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    TTF_Quit();
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "board_layer.h"
+
+#include <string.h>
+
+// Grid, border and static obstacles for `view`, in the colours the
+// front-ends have always used
+static void draw_static(RenderQueue *queue, const BoardView *view, const Game *game) {
+    int left = view->screenX;
+    int top = view->screenY;
+    int right = left + view->cols * view->cellSize;
+    int bottom = top + view->rows * view->cellSize;
+
+    // Skip the grid lines when the cells are too small for them to help
+    if (view->cellSize >= 8) {
+        set_queue_layer(queue, LAYER_GRID);
+        set_queue_color(queue, 50, 50, 50, 255);
+
+        for (int x = left; x <= right; x += view->cellSize) {
+            queue_draw_line(queue, x, top, x, bottom);
+        }
+
+        for (int y = top; y <= bottom; y += view->cellSize) {
+            queue_draw_line(queue, left, y, right, y);
+        }
+    }
+
+    // A more prominent border around the grid
+    set_queue_layer(queue, LAYER_BORDER);
+    set_queue_color(queue, 100, 100, 100, 255);
+    SDL_Rect border = {left, top, right - left, bottom - top};
+    queue_draw_rect(queue, &border);
+
+    // Regular obstacles are gray; moving ones are left to the front-end
+    set_queue_layer(queue, LAYER_ITEMS);
+    set_queue_color(queue, 100, 100, 100, 255);
+    for (int i = 0; i < game->obstacleCount; i++) {
+        const Obstacle *obstacle = &game->obstacles[i];
+        if (obstacle->moving || !view_contains(view, obstacle->x, obstacle->y)) continue;
+
+        SDL_Rect rect = {
+            view_screen_x(view, obstacle->x),
+            view_screen_y(view, obstacle->y),
+            view->cellSize,
+            view->cellSize
+        };
+        queue_fill_rect(queue, &rect);
+    }
+}
+
+// Redraw the texture for `view` if it is out of date. Returns false if
+// there is no texture to draw from.
+static bool prepare_layer(RenderQueue *queue, BoardLayer *layer, const BoardView *view, const Game *game) {
+    if (layer->valid && layer->layout == game->layout &&
+        memcmp(&layer->view, view, sizeof(BoardView)) == 0) {
+        return true;
+    }
+    if (!SDL_RenderTargetSupported(queue->renderer)) return false;
+
+    // The border and the last grid lines sit one pixel past the last cell
+    int width = view->cols * view->cellSize + 1;
+    int height = view->rows * view->cellSize + 1;
+
+    if (!layer->texture || layer->width != width || layer->height != height) {
+        // The old texture may still be waiting in the queue
+        if (layer->texture) {
+            flush_render_queue(queue);
+            SDL_DestroyTexture(layer->texture);
+        }
+        layer->texture = SDL_CreateTexture(queue->renderer, SDL_PIXELFORMAT_RGBA8888,
+                                           SDL_TEXTUREACCESS_TARGET, width, height);
+        if (!layer->texture) {
+            layer->valid = false;
+            return false;
+        }
+        SDL_SetTextureBlendMode(layer->texture, SDL_BLENDMODE_NONE);
+        layer->width = width;
+        layer->height = height;
+    }
+
+    // Draw as if the board started at the top-left corner of the screen
+    BoardView local = *view;
+    local.screenX = 0;
+    local.screenY = 0;
+
+    SDL_Texture *target = SDL_GetRenderTarget(queue->renderer);
+    set_queue_target(queue, layer->texture);
+    set_queue_color(queue, 0, 0, 0, 255);
+    queue_clear(queue);
+    draw_static(queue, &local, game);
+    set_queue_target(queue, target);
+
+    layer->view = *view;
+    layer->layout = game->layout;
+    layer->valid = true;
+    return true;
+}
+
+void draw_board_layer(RenderQueue *queue, BoardLayer *layer, const BoardView *view, const Game *game,
+                      const SDL_Rect *area) {
+    SDL_Rect board = {view->screenX, view->screenY, view->cols * view->cellSize + 1,
+                      view->rows * view->cellSize + 1};
+    SDL_Rect rect;
+    if (!area) {
+        rect = board;
+    } else if (!SDL_IntersectRect(area, &board, &rect)) {
+        return;
+    }
+
+    if (!prepare_layer(queue, layer, view, game)) {
+        set_queue_layer(queue, LAYER_BACKGROUND);
+        set_queue_color(queue, 0, 0, 0, 255);
+        queue_fill_rect(queue, &rect);
+        draw_static(queue, view, game);
+        return;
+    }
+
+    SDL_Rect source = {rect.x - board.x, rect.y - board.y, rect.w, rect.h};
+    set_queue_layer(queue, LAYER_GRID);
+    queue_copy(queue, layer->texture, &source, &rect);
+}
+
+void invalidate_board_layer(BoardLayer *layer) {
+    layer->valid = false;
+}
+
+void free_board_layer(BoardLayer *layer) {
+    if (layer->texture) SDL_DestroyTexture(layer->texture);
+    layer->texture = NULL;
+    layer->width = layer->height = 0;
+    layer->valid = false;
+}
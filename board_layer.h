@@ -0,0 +1,40 @@
+#ifndef BOARD_LAYER_H
+#define BOARD_LAYER_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#include "board_view.h"
+#include "render_queue.h"
+#include "snake_sim.h"
+
+// The parts of the board that stay put for a whole match: the black play
+// area, the grid lines, the border and the obstacles that don't move. They
+// are drawn once into a target texture the size of the visible board and
+// then queued as a single textured quad on LAYER_GRID, so fruit, moving
+// obstacles and snakes only have to be drawn on top.
+//
+// The texture is redrawn when the view or the game's layout stamp changes,
+// which covers new matches and mode switches. Without render target support
+// the same things are queued directly every time instead.
+typedef struct {
+    SDL_Texture *texture;  // NULL until first drawn, or if unsupported
+    int width, height;     // Texture size in pixels
+    BoardView view;        // View the texture was drawn for
+    unsigned layout;       // Game layout stamp it was drawn for
+    bool valid;
+} BoardLayer;
+
+// Queue the layer under `area` of the screen, or under the whole board if
+// `area` is NULL; callers repainting part of the board clip to `area`.
+// Redrawing the texture changes the render target, so call it before
+// setting a clip rect.
+void draw_board_layer(RenderQueue *queue, BoardLayer *layer, const BoardView *view, const Game *game,
+                      const SDL_Rect *area);
+
+// Force a redraw on the next draw, e.g. after SDL_RENDER_TARGETS_RESET
+void invalidate_board_layer(BoardLayer *layer);
+
+void free_board_layer(BoardLayer *layer);
+
+#endif
@@ -0,0 +1,38 @@
+#include "board_view.h"
+
+// Lay out one axis: how many cells fit, which one comes first and where it
+// goes on screen
+static void fit_axis(int board, int area, int start, int cell_size, int focus,
+                     int *first, int *count, int *screen) {
+    *count = area / cell_size;
+
+    if (*count >= board) {
+        // Everything fits, centre the board in the area
+        *count = board;
+        *first = 0;
+    } else {
+        // Scroll, keeping the focus cell in the middle where possible
+        *first = focus - *count / 2;
+        if (*first > board - *count) *first = board - *count;
+        if (*first < 0) *first = 0;
+    }
+
+    *screen = start + (area - *count * cell_size) / 2;
+}
+
+void update_board_view(BoardView *view, const Game *game, int focusX, int focusY) {
+    int area_width = WINDOW_WIDTH;
+    int area_height = WINDOW_HEIGHT - UI_HEIGHT;
+
+    // Largest cell size that shows the whole board, within limits
+    int cell_size = area_width / game->width;
+    if (area_height / game->height < cell_size) cell_size = area_height / game->height;
+    if (cell_size > CELL_SIZE * 2) cell_size = CELL_SIZE * 2;
+    if (cell_size < MIN_CELL_SIZE) cell_size = MIN_CELL_SIZE;
+    view->cellSize = cell_size;
+
+    fit_axis(game->width, area_width, 0, cell_size, focusX,
+             &view->firstX, &view->cols, &view->screenX);
+    fit_axis(game->height, area_height, UI_HEIGHT, cell_size, focusY,
+             &view->firstY, &view->rows, &view->screenY);
+}
@@ -0,0 +1,50 @@
+#ifndef BOARD_VIEW_H
+#define BOARD_VIEW_H
+
+#include <stdbool.h>
+
+#include "snake_sim.h"
+
+// Screen layout shared by the front-ends. The window keeps the size of the
+// default 32x24 board; other boards are scaled to fit the play area, and
+// boards too big to fit at MIN_CELL_SIZE scroll to follow the action.
+
+#define CELL_SIZE 20     // Cell size in pixels at the default board size
+#define MIN_CELL_SIZE 4  // Smallest cell before the view starts scrolling
+
+// UI dimensions
+#define UI_HEIGHT 60  // Height of the UI area above the grid
+#define UI_PADDING 10 // Padding inside UI area
+
+// Window dimensions
+#define WINDOW_WIDTH (DEFAULT_GRID_WIDTH * CELL_SIZE)
+#define WINDOW_HEIGHT (DEFAULT_GRID_HEIGHT * CELL_SIZE + UI_HEIGHT)
+
+// Which part of the board is on screen and where
+typedef struct {
+    int cellSize;             // Pixels per cell
+    int firstX, firstY;       // Top-left visible cell
+    int cols, rows;           // Number of visible cells
+    int screenX, screenY;     // Screen position of the top-left visible cell
+} BoardView;
+
+// Fit the board into the play area below the UI bar. When it has to scroll,
+// the view is centred on cell (focusX, focusY) as far as the board edges
+// allow.
+void update_board_view(BoardView *view, const Game *game, int focusX, int focusY);
+
+static inline bool view_contains(const BoardView *view, int x, int y) {
+    return x >= view->firstX && x < view->firstX + view->cols &&
+           y >= view->firstY && y < view->firstY + view->rows;
+}
+
+// Screen position of the top-left corner of a cell
+static inline int view_screen_x(const BoardView *view, int x) {
+    return view->screenX + (x - view->firstX) * view->cellSize;
+}
+
+static inline int view_screen_y(const BoardView *view, int y) {
+    return view->screenY + (y - view->firstY) * view->cellSize;
+}
+
+#endif
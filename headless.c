@@ -0,0 +1,166 @@
+#include "headless.h"
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+
+#include "agents.h"
+#include "replay.h"
+#include "trace.h"
+
+typedef struct {
+    long matches;
+    long long ticks;
+    Uint64 counter;  // Performance counter ticks spent stepping
+} HeadlessTotals;
+
+static const char *mode_name(GameMode mode) {
+    switch (mode) {
+        case MODE_SINGLE: return "single";
+        case MODE_CHALLENGE: return "challenge";
+        case MODE_MULTI: return "multi";
+    }
+    return "?";
+}
+
+static void report_match(const Game *game, GameMode mode, const char *source) {
+    printf("%s %s: %u ticks, score", mode_name(mode), source, game->tick);
+    for (int i = 0; i < game->snakeCount; i++) {
+        printf(" %d", game->snakes[i].score);
+    }
+    printf("%s\n", game->over ? "" : " (stopped at --max-ticks)");
+}
+
+static bool play_agent_matches(const GameOptions *options, GameMode mode, const Agent *agent,
+                               uint64_t seed, HeadlessTotals *totals) {
+    // Challenge mode normally gets its features from the checkbox screen
+    GameFeatures everything = {true, true, true, true, true, true};
+    Game game = {0};
+    ReplayRecorder recorder = {0};
+    bool ok = true;
+
+    for (int match = 0; ok && match < options->matches; match++) {
+        if (!configure_game(&game, mode, mode == MODE_CHALLENGE ? &everything : NULL,
+                            options->boardWidth, options->boardHeight)) {
+            printf("Out of memory\n");
+            ok = false;
+            break;
+        }
+        seed_game(&game, seed + (uint64_t)match);
+        reset_game(&game);
+
+        // The agent gets its own stream so it doesn't shift fruit placement
+        Rng agentRng;
+        rng_seed(&agentRng, seed + (uint64_t)match, 1);
+        GameInput input = {{DIR_NONE, DIR_NONE}};
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        while (!game.over && game.tick < options->maxTicks) {
+            for (int i = 0; i < game.snakeCount; i++) {
+                input.dir[i] = game.snakes[i].alive ? agent->choose(&game, i, &agentRng) : DIR_NONE;
+            }
+            if (options->recordPath) record_input(&recorder, &game, &input);
+            step_game(&game, &input);
+        }
+        totals->counter += SDL_GetPerformanceCounter() - start;
+        totals->ticks += game.tick;
+        totals->matches++;
+
+        char source[64];
+        snprintf(source, sizeof(source), "seed %llu", (unsigned long long)(seed + (uint64_t)match));
+        report_match(&game, mode, source);
+
+        if (options->recordPath) {
+            if (options->matches == 1) {
+                ok = save_replay(&recorder, &game, options->recordPath);
+            } else {
+                char path[1024];
+                snprintf(path, sizeof(path), "%s%d.rpl", options->recordPath, match);
+                ok = save_replay(&recorder, &game, path);
+            }
+        }
+    }
+
+    free_recorder(&recorder);
+    free_game(&game);
+    return ok;
+}
+
+static bool play_replay(const GameOptions *options, const GameMode *mode, HeadlessTotals *totals) {
+    Replay replay;
+    if (!load_replay(&replay, options->replayPath)) return false;
+
+    if (mode && replay.mode != *mode) {
+        printf("%s: recorded in %s mode, this is %s mode\n", options->replayPath,
+               mode_name(replay.mode), mode_name(*mode));
+        free_replay(&replay);
+        return false;
+    }
+
+    Game game = {0};
+    bool ok = true;
+
+    for (int run = 0; ok && run < options->matches; run++) {
+        if (!start_replay(&replay, &game)) {
+            printf("Out of memory\n");
+            ok = false;
+            break;
+        }
+
+        GameInput input;
+        Uint64 start = SDL_GetPerformanceCounter();
+        while (replay_input(&replay, &game, &input)) {
+            step_game(&game, &input);
+        }
+        totals->counter += SDL_GetPerformanceCounter() - start;
+        totals->ticks += game.tick;
+        totals->matches++;
+
+        report_match(&game, replay.mode, options->replayPath);
+        if (!replay_matches(&replay, &game)) {
+            printf("%s: ended differently from the recording (%u ticks, score", options->replayPath,
+                   replay.ticks);
+            for (int i = 0; i < game.snakeCount; i++) printf(" %d", replay.score[i]);
+            printf(")\n");
+            ok = false;
+        }
+    }
+
+    free_game(&game);
+    free_replay(&replay);
+    return ok;
+}
+
+int run_headless(const GameOptions *options, const GameMode *mode) {
+    HeadlessTotals totals = {0};
+    bool ok;
+
+    const Agent *agent = find_agent(options->agentName);
+    if (!agent) {
+        printf("--agent must be one of %s, got \"%s\"\n", agent_names(), options->agentName);
+        return 1;
+    }
+
+    // Only the last TRACE_BUFFER_SIZE spans are kept, the end of the run
+    if (options->tracePath) start_trace(options->tracePath);
+
+    if (options->replayPath) {
+        ok = play_replay(options, mode, &totals);
+    } else {
+        // Every mode plays the same seeds
+        uint64_t seed = choose_seed(options);
+        const GameMode modes[] = {MODE_SINGLE, MODE_CHALLENGE, MODE_MULTI};
+        ok = true;
+        for (int i = 0; ok && i < 3; i++) {
+            if (mode && modes[i] != *mode) continue;
+            ok = play_agent_matches(options, modes[i], agent, seed, &totals);
+        }
+    }
+
+    double seconds = (double)totals.counter / SDL_GetPerformanceFrequency();
+    if (totals.matches > 0) {
+        printf("headless: %ld matches, %lld ticks in %.1f ms, %.0f ticks/sec\n", totals.matches,
+               totals.ticks, seconds * 1000, seconds > 0 ? totals.ticks / seconds : 0.0);
+    }
+    if (options->tracePath) stop_trace();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,30 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include "options.h"
+#include "snake_sim.h"
+
+// --headless: play the game's matches with no window, renderer, audio
+// device or assets, for CI and servers without a display. SDL isn't
+// initialized at all, so nothing needs a video or audio driver.
+//
+// The same simulation the window drives is stepped as fast as it runs.
+// With --replay FILE the recorded inputs play it back to its end
+// (--matches times) and every run must finish the way the recording did.
+// Otherwise the --agent (see agents.h) plays every snake, on seeds --seed,
+// --seed + 1, ... for --matches matches, and a match still going after
+// --max-ticks ticks is stopped there. Challenge mode plays with every
+// feature on, as there is no checkbox screen to pick them. --record saves
+// each agent match, to the path itself for one match or to PATH<n>.rpl for
+// several.
+//
+// Prints every match's ticks and scores, then the total ticks and ticks
+// per second.
+
+// Play `mode`'s matches, or each mode's in turn when `mode` is NULL (the
+// launcher). A replay plays in the mode it was recorded in, which must be
+// `mode` when one is given. Returns the exit status: 0, or 1 after
+// printing why a match couldn't be played or a replay didn't match.
+int run_headless(const GameOptions *options, const GameMode *mode);
+
+#endif
@@ -0,0 +1,213 @@
+#include "host.h"
+
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "board_view.h"
+#include "metrics.h"
+#include "trace.h"
+
+#define HUD_FONT "dejavu-fonts-ttf-2.37/ttf/DejaVuSans.ttf"
+#define HUD_FONT_SIZE 14
+
+// F3 toggles the performance overlay and F9 writes the trace so far; a
+// watch sees the keys whichever scene is up
+static int watch_keys(void *data, SDL_Event *event) {
+    Host *host = data;
+    if (event->type != SDL_KEYDOWN || event->key.repeat) return 0;
+
+    if (event->key.keysym.sym == SDLK_F3) {
+        host->hud.visible = !host->hud.visible;
+    } else if (event->key.keysym.sym == SDLK_F9 && host->tracing) {
+        dump_trace();
+    }
+    return 0;
+}
+
+bool open_host(Host *host, const char *title, const GameOptions *options) {
+    memset(host, 0, sizeof(Host));
+    host->sceneStart = SDL_GetPerformanceCounter();
+
+    // Everything below loads from the pack when there is one
+    open_asset_pack(&host->assets, ASSET_PACK_FILE);
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
+        close_asset_pack(&host->assets);
+        return false;
+    }
+
+    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+        printf("SDL_image could not initialize! IMG_Error: %s\n", IMG_GetError());
+        close_host(host);
+        return false;
+    }
+
+    if (TTF_Init() < 0) {
+        printf("SDL_ttf could not initialize! SDL_ttf Error: %s\n", TTF_GetError());
+        close_host(host);
+        return false;
+    }
+
+    // Before the audio thread starts, as it counts underruns
+    if (options->metricsPath && !start_metrics(options->metricsPath)) {
+        close_host(host);
+        return false;
+    }
+
+#ifndef SNAKE_HEADLESS
+    if (Mix_OpenAudio(PACK_SOUND_FREQUENCY, MIX_DEFAULT_FORMAT, PACK_SOUND_CHANNELS,
+                      options->audioBuffer) < 0) {
+        printf("SDL_mixer could not initialize! SDL_mixer Error: %s\n", Mix_GetError());
+        close_host(host);
+        return false;
+    }
+    start_sound_queue(&host->audio, options->audioBuffer, options->measureAudio);
+    host->audioOpen = true;
+#endif
+
+    host->window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                    WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
+    if (!host->window) {
+        printf("Window could not be created! SDL_Error: %s\n", SDL_GetError());
+        close_host(host);
+        return false;
+    }
+
+    host->renderer = SDL_CreateRenderer(host->window, -1, SDL_RENDERER_ACCELERATED);
+    if (!host->renderer) {
+        printf("Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
+        close_host(host);
+        return false;
+    }
+    init_render_queue(&host->queue, host->renderer);
+
+    upload_pack_atlas(&host->assets, host->renderer);
+
+    if (options->tracePath) {
+        start_trace(options->tracePath);
+        host->tracing = true;
+    }
+    SDL_AddEventWatch(watch_keys, host);
+    return true;
+}
+
+void close_host(Host *host) {
+    // The audio thread reads the sounds until the queue is stopped
+    if (host->audioOpen) stop_sound_queue(&host->audio);
+    host->audioOpen = false;
+
+    // Nothing counts or records spans any more, the audio thread included
+    SDL_DelEventWatch(watch_keys, host);
+    stop_metrics();
+    if (host->tracing) stop_trace();
+    host->tracing = false;
+
+    for (int i = 0; i < host->fontCount; i++) close_font(host->fonts[i].font);
+    for (int i = 0; i < host->spriteCount; i++) free_sprite(&host->sprites[i].sprite);
+#ifndef SNAKE_HEADLESS
+    for (int i = 0; i < host->soundCount; i++) Mix_FreeChunk(host->sounds[i].chunk);
+    host->soundCount = 0;
+#endif
+    host->fontCount = host->spriteCount = 0;
+
+    // Sounds and the atlas may point into the pack, and the atlas belongs
+    // to the renderer
+    if (host->renderer) free_render_queue(&host->queue);
+    close_asset_pack(&host->assets);
+    if (host->renderer) SDL_DestroyRenderer(host->renderer);
+    if (host->window) SDL_DestroyWindow(host->window);
+    host->renderer = NULL;
+    host->window = NULL;
+
+    // Each of these is safe to call whether or not its init succeeded
+#ifndef SNAKE_HEADLESS
+    Mix_CloseAudio();
+#endif
+    TTF_Quit();
+    IMG_Quit();
+    SDL_Quit();
+}
+
+void enter_scene(Host *host, const char *title) {
+    SDL_SetWindowTitle(host->window, title);
+
+    // Nothing of the last scene's frame is wanted; the new one starts with
+    // a clear
+    set_queue_target(&host->queue, NULL);
+    set_queue_clip(&host->queue, NULL);
+    set_queue_layer(&host->queue, LAYER_BACKGROUND);
+}
+
+Font *host_font(Host *host, const char *path, int size, bool smooth) {
+    for (int i = 0; i < host->fontCount; i++) {
+        HostFont *entry = &host->fonts[i];
+        if (entry->size == size && entry->smooth == smooth && strcmp(entry->path, path) == 0) {
+            return entry->font;
+        }
+    }
+
+    Font *font = load_font(&host->assets, host->renderer, path, size, smooth);
+    if (font && host->fontCount < MAX_HOST_FONTS) {
+        host->fonts[host->fontCount++] = (HostFont){path, size, smooth, font};
+    } else if (font) {
+        printf("Too many fonts to keep; raise MAX_HOST_FONTS\n");
+        close_font(font);
+        font = NULL;
+    }
+    return font;
+}
+
+const Sprite *host_sprite(Host *host, const char *path) {
+    for (int i = 0; i < host->spriteCount; i++) {
+        if (strcmp(host->sprites[i].path, path) == 0) return &host->sprites[i].sprite;
+    }
+    if (host->spriteCount == MAX_HOST_SPRITES) {
+        printf("Too many sprites to keep; raise MAX_HOST_SPRITES\n");
+        return NULL;
+    }
+
+    HostSprite *entry = &host->sprites[host->spriteCount];
+    if (!load_sprite(&host->assets, host->renderer, path, &entry->sprite)) return NULL;
+    entry->path = path;
+    host->spriteCount++;
+    return &entry->sprite;
+}
+
+#ifndef SNAKE_HEADLESS
+Mix_Chunk *host_sound(Host *host, const char *path) {
+    for (int i = 0; i < host->soundCount; i++) {
+        if (strcmp(host->sounds[i].path, path) == 0) return host->sounds[i].chunk;
+    }
+
+    Mix_Chunk *chunk = load_sound(&host->assets, path);
+    if (chunk && host->soundCount < MAX_HOST_SOUNDS) {
+        host->sounds[host->soundCount++] = (HostSound){path, chunk};
+    } else if (chunk) {
+        printf("Too many sounds to keep; raise MAX_HOST_SOUNDS\n");
+        Mix_FreeChunk(chunk);
+        chunk = NULL;
+    }
+    return chunk;
+}
+#endif
+
+void report_first_frame(const Host *host, const char *scene) {
+    double ms = (SDL_GetPerformanceCounter() - host->sceneStart) * 1000.0 / SDL_GetPerformanceFrequency();
+    printf("%s: first frame after %.1f ms, assets from %s\n", scene, ms,
+           host->assets.data ? ASSET_PACK_FILE : "loose files");
+}
+
+void draw_host_hud(Host *host) {
+    unsigned labelMisses = 0;
+    for (int i = 0; i < host->fontCount; i++) labelMisses += host->fonts[i].font->labelMisses;
+
+    // Loaded the first time the overlay comes up
+    Font *font = host->hud.visible ? host_font(host, HUD_FONT, HUD_FONT_SIZE, false) : NULL;
+    count_frame();
+    TRACE_BEGIN(hud);
+    draw_perf_hud(&host->hud, &host->queue, font, labelMisses);
+    TRACE_END(hud, "draw_perf_hud");
+}
@@ -0,0 +1,140 @@
+#ifndef HOST_H
+#define HOST_H
+
+#include <SDL2/SDL.h>
+#ifndef SNAKE_HEADLESS
+#include <SDL2/SDL_mixer.h>
+#endif
+#include <stdbool.h>
+
+#include "asset_pack.h"
+#include "options.h"
+#include "perf_hud.h"
+#include "render_queue.h"
+#include "sound_queue.h"
+#include "text.h"
+
+// What the front-ends share for the life of the process: SDL and its
+// libraries, the window, the renderer and its queue, the audio device, the
+// asset pack and every font, sprite and sound loaded from it.
+//
+// Each mode runs as a scene, a function that takes over the window until
+// the player leaves it. Built on its own, a mode opens a Host in main() and
+// runs its scene once. The launcher (menu.c, built with SNAKE_LAUNCHER
+// defined) links all of them into one binary and switches between the menu
+// and the modes in the same Host, so a switch starts a loop instead of a
+// process and finds its fonts and textures already loaded.
+//
+// Built with SNAKE_HEADLESS the host opens no audio device and loads no
+// sounds: host_sound() returns NULL and play_sound() does nothing, so the
+// game links without SDL_mixer. --headless runs need nothing more, e.g.
+//
+//     gcc -DSNAKE_LAUNCHER -DSNAKE_HEADLESS -o snake_headless agents.c asset_pack.c
+//         attempt.c board_layer.c board_view.c challenge.c headless.c host.c menu.c
+//         metrics.c multiplayer.c options.c perf_hud.c render_queue.c replay.c
+//         snake_sim.c snake_sprites.c sound_queue.c text.c trace.c
+//         -lSDL2 -lSDL2_image -lSDL2_ttf
+//
+// which is also the project's Headless target.
+
+#define MAX_HOST_FONTS 6
+#define MAX_HOST_SPRITES 8
+#define MAX_HOST_SOUNDS 4
+
+typedef enum {
+    SCENE_MENU,
+    SCENE_SINGLE_PLAYER,
+    SCENE_CHALLENGE,
+    SCENE_MULTIPLAYER,
+    SCENE_QUIT,
+    SCENE_FAILED  // Couldn't start; it has printed why
+} Scene;
+
+typedef struct {
+    const char *path;  // As passed in; callers use string literals
+    int size;
+    bool smooth;
+    Font *font;
+} HostFont;
+
+typedef struct {
+    const char *path;
+    Sprite sprite;
+} HostSprite;
+
+#ifndef SNAKE_HEADLESS
+typedef struct {
+    const char *path;
+    Mix_Chunk *chunk;
+} HostSound;
+#else
+typedef struct Mix_Chunk Mix_Chunk;
+#endif
+
+typedef struct {
+    SDL_Window *window;
+    SDL_Renderer *renderer;
+    RenderQueue queue;
+    SoundQueue audio;  // Play sound effects through this
+    bool audioOpen;
+    bool tracing;      // --trace
+    PerfHud hud;       // F3 shows it in every scene
+    AssetPack assets;
+
+    HostFont fonts[MAX_HOST_FONTS];
+    int fontCount;
+    HostSprite sprites[MAX_HOST_SPRITES];
+    int spriteCount;
+#ifndef SNAKE_HEADLESS
+    HostSound sounds[MAX_HOST_SOUNDS];
+    int soundCount;
+#endif
+
+    // Performance counter at launch or when the current scene was switched
+    // to, for report_first_frame(); main() sets it
+    Uint64 sceneStart;
+} Host;
+
+// Initialize SDL, SDL_image, SDL_ttf and the mixer, open the window and
+// renderer and map the asset pack. The mixer buffer and audio measurement
+// come from `options`. Prints a message and returns false on failure, with
+// everything opened so far closed again.
+bool open_host(Host *host, const char *title, const GameOptions *options);
+void close_host(Host *host);
+
+// Set the window title and put the renderer back in its default state,
+// first thing in a scene
+void enter_scene(Host *host, const char *title);
+
+// Loaded on first use and kept until close_host(). They return NULL (or
+// false) on failure as load_font(), load_sprite() and load_sound() do, and
+// try again on the next call.
+Font *host_font(Host *host, const char *path, int size, bool smooth);
+const Sprite *host_sprite(Host *host, const char *path);
+#ifndef SNAKE_HEADLESS
+Mix_Chunk *host_sound(Host *host, const char *path);
+#else
+static inline Mix_Chunk *host_sound(Host *host, const char *path) {
+    (void)host;
+    (void)path;
+    return NULL;
+}
+#endif
+
+// Print the time from host->sceneStart to now; scenes call it after
+// presenting their first frame when --measure-startup is given
+void report_first_frame(const Host *host, const char *scene);
+
+// Record the frame for the performance overlay and the metrics, and queue
+// the overlay when it is up; scenes call it last thing before every present
+void draw_host_hud(Host *host);
+
+// The scenes, in attempt.c, challenge.c, multiplayer.c and menu.c. Each
+// returns the scene to switch to: SCENE_QUIT when the window is closed,
+// SCENE_MENU when the player leaves for the menu.
+Scene run_menu(Host *host, const GameOptions *options);
+Scene run_single_player(Host *host, const GameOptions *options);
+Scene run_challenge(Host *host, const GameOptions *options);
+Scene run_multiplayer(Host *host, const GameOptions *options);
+
+#endif
@@ -3,253 +3,179 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
-#include <unistd.h>  // For execl function
 
-#define SCREEN_WIDTH 800
-#define SCREEN_HEIGHT 600
-#define BUTTON_WIDTH 200
-#define BUTTON_HEIGHT 50
-
-typedef enum {
-    MENU,
-    SINGLE_PLAYER,
-    CHALLENGE_MODE,
-    TWO_PLAYER,
-    QUIT
-} GameState;
-
-GameState currentGameState = MENU;
-
-// Button positions
-SDL_Rect singlePlayerButton = {300, 200, BUTTON_WIDTH, BUTTON_HEIGHT};
-SDL_Rect challengeModeButton = {300, 300, BUTTON_WIDTH, BUTTON_HEIGHT};
-SDL_Rect twoPlayerButton = {300, 400, BUTTON_WIDTH, BUTTON_HEIGHT};
-
-// SDL variables
-SDL_Window* window = NULL;
-SDL_Renderer* renderer = NULL;
-TTF_Font* font = NULL;
-
-// Function declarations
-void renderMenu();
-void handleMenuEvents();
-void cleanup();
-SDL_Texture* renderText(const char* text, SDL_Color color, SDL_Rect* destRect);
-
-// Initialize SDL and TTF
-bool init() {
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
-        return false;
-    }
-
-    if (TTF_Init() < 0) {
-        printf("SDL_ttf could not initialize! TTF_Error: %s\n", TTF_GetError());
-        return false;
-    }
-
-    window = SDL_CreateWindow("Snake Game",
-                              SDL_WINDOWPOS_CENTERED,
-                              SDL_WINDOWPOS_CENTERED,
-                              SCREEN_WIDTH, SCREEN_HEIGHT,
-                              SDL_WINDOW_SHOWN);
-    if (!window) {
-        printf("Window could not be created! SDL_Error: %s\n", SDL_GetError());
-        return false;
-    }
-
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    if (!renderer) {
-        printf("Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
-        SDL_DestroyWindow(window);
-        return false;
-    }
+#include "board_view.h"
+#include "headless.h"
+#include "host.h"
+#include "options.h"
+#include "render_queue.h"
+#include "text.h"
+#include "trace.h"
 
-    // Load font with better error handling
-    font = TTF_OpenFont("dejavu-fonts-ttf-2.37/ttf/DejaVuSans.ttf", 24);
-    if (!font) {
-        printf("Failed to load font! TTF_Error: %s\n", TTF_GetError());
-        printf("Attempted to load font at: dejavu-fonts-ttf-2.37/ttf/DejaVuSans.ttf\n");
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
-        return false;
-    }
+// The launcher: the menu and the three modes in one process, built with
+// SNAKE_LAUNCHER defined so attempt.c, challenge.c and multiplayer.c leave
+// out their own main(). Leaving a mode (its EXIT button, or Escape outside
+// a match) comes back here. With --headless it plays every mode's matches
+// instead, with no window.
 
-    return true;
-}
-
-// Cleanup function
-void cleanup() {
-    TTF_CloseFont(font);
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-    TTF_Quit();
-    SDL_Quit();
-}
-
-// Render text helper function
-SDL_Texture* renderText(const char* text, SDL_Color color, SDL_Rect* destRect) {
-    if (!font) {
-        printf("Error in renderText: Font not loaded!\n");
-        return NULL;
-    }
-
-    if (!text) {
-        printf("Error in renderText: Null text string!\n");
-        return NULL;
-    }
-
-    SDL_Surface* surface = TTF_RenderText_Solid(font, text, color);
-    if (!surface) {
-        printf("Unable to render text surface! SDL_ttf Error: %s\n", TTF_GetError());
-        return NULL;
-    }
-
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (!texture) {
-        printf("Unable to create texture from rendered text! SDL Error: %s\n", SDL_GetError());
-        SDL_FreeSurface(surface);
-        return NULL;
-    }
+#define BUTTON_WIDTH 200
+#define BUTTON_HEIGHT 50
 
-    destRect->w = surface->w;
-    destRect->h = surface->h;
-    SDL_FreeSurface(surface);
-    return texture;
-}
+// Button positions, centred in the window the modes share
+#define BUTTON_X (WINDOW_WIDTH / 2 - BUTTON_WIDTH / 2)
+static SDL_Rect singlePlayerButton = {BUTTON_X, 200, BUTTON_WIDTH, BUTTON_HEIGHT};
+static SDL_Rect challengeModeButton = {BUTTON_X, 300, BUTTON_WIDTH, BUTTON_HEIGHT};
+static SDL_Rect twoPlayerButton = {BUTTON_X, 400, BUTTON_WIDTH, BUTTON_HEIGHT};
 
-// Render the main menu
-void renderMenu() {
+// Queue the main menu; the caller presents it
+static void renderMenu(RenderQueue *queue, Font *font) {
     // Clear screen
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-    SDL_RenderClear(renderer);
-
-    SDL_Color titleColor = {0, 255, 0}; // Green
-    SDL_Rect titleRect = {0, 100, 0, 0}; // Width and height will be set by renderText
-    SDL_Texture* titleTexture = renderText("Welcome to Snake Game", titleColor, &titleRect);
-    // Center the title
-    titleRect.x = (SCREEN_WIDTH - titleRect.w) / 2;
-
-    SDL_Color buttonColor = {255, 255, 255}; // White
+    set_queue_color(queue, 0, 0, 0, 255);
+    queue_clear(queue);
 
-    // Center text in buttons
-    SDL_Rect singlePlayerTextRect = {0, 0, 0, 0};
-    SDL_Texture* singlePlayerTexture = renderText("Single Player", buttonColor, &singlePlayerTextRect);
-    singlePlayerTextRect.x = singlePlayerButton.x + (singlePlayerButton.w - singlePlayerTextRect.w) / 2;
-    singlePlayerTextRect.y = singlePlayerButton.y + (singlePlayerButton.h - singlePlayerTextRect.h) / 2;
+    SDL_Color titleColor = {0, 255, 0, 255}; // Green
+    SDL_Color buttonColor = {255, 255, 255, 255}; // White
 
-    SDL_Rect challengeModeTextRect = {0, 0, 0, 0};
-    SDL_Texture* challengeModeTexture = renderText("Challenge Mode", buttonColor, &challengeModeTextRect);
-    challengeModeTextRect.x = challengeModeButton.x + (challengeModeButton.w - challengeModeTextRect.w) / 2;
-    challengeModeTextRect.y = challengeModeButton.y + (challengeModeButton.h - challengeModeTextRect.h) / 2;
-
-    SDL_Rect twoPlayerTextRect = {0, 0, 0, 0};
-    SDL_Texture* twoPlayerTexture = renderText("2 Player", buttonColor, &twoPlayerTextRect);
-    twoPlayerTextRect.x = twoPlayerButton.x + (twoPlayerButton.w - twoPlayerTextRect.w) / 2;
-    twoPlayerTextRect.y = twoPlayerButton.y + (twoPlayerButton.h - twoPlayerTextRect.h) / 2;
-
-    // Draw title
-    SDL_RenderCopy(renderer, titleTexture, NULL, &titleRect);
+    // Draw title, centered horizontally with its top at y = 100
+    int titleHeight;
+    text_size(font, "Welcome to Snake Game", NULL, &titleHeight);
+    draw_label_centered(queue, font, "Welcome to Snake Game", WINDOW_WIDTH / 2, 100 + titleHeight / 2, titleColor);
 
     // Draw buttons
-    SDL_SetRenderDrawColor(renderer, 50, 50, 150, 255); // Dark blue button
-    SDL_RenderFillRect(renderer, &singlePlayerButton);
-    SDL_RenderFillRect(renderer, &challengeModeButton);
-    SDL_RenderFillRect(renderer, &twoPlayerButton);
+    set_queue_layer(queue, LAYER_PANEL);
+    set_queue_color(queue, 50, 50, 150, 255); // Dark blue button
+    queue_fill_rect(queue, &singlePlayerButton);
+    queue_fill_rect(queue, &challengeModeButton);
+    queue_fill_rect(queue, &twoPlayerButton);
 
     // Draw button borders
-    SDL_SetRenderDrawColor(renderer, 80, 80, 200, 255); // Light blue border
-    SDL_RenderDrawRect(renderer, &singlePlayerButton);
-    SDL_RenderDrawRect(renderer, &challengeModeButton);
-    SDL_RenderDrawRect(renderer, &twoPlayerButton);
-
-    // Draw button texts
-    SDL_RenderCopy(renderer, singlePlayerTexture, NULL, &singlePlayerTextRect);
-    SDL_RenderCopy(renderer, challengeModeTexture, NULL, &challengeModeTextRect);
-    SDL_RenderCopy(renderer, twoPlayerTexture, NULL, &twoPlayerTextRect);
-
-    // Present renderer
-    SDL_RenderPresent(renderer);
-
-    // Clean up textures
-    SDL_DestroyTexture(titleTexture);
-    SDL_DestroyTexture(singlePlayerTexture);
-    SDL_DestroyTexture(challengeModeTexture);
-    SDL_DestroyTexture(twoPlayerTexture);
-}
+    set_queue_layer(queue, LAYER_OUTLINE);
+    set_queue_color(queue, 80, 80, 200, 255); // Light blue border
+    queue_draw_rect(queue, &singlePlayerButton);
+    queue_draw_rect(queue, &challengeModeButton);
+    queue_draw_rect(queue, &twoPlayerButton);
+
+    // Draw button texts, cached after the first frame
+    draw_label_centered(queue, font, "Single Player",
+                        singlePlayerButton.x + singlePlayerButton.w / 2,
+                        singlePlayerButton.y + singlePlayerButton.h / 2, buttonColor);
+    draw_label_centered(queue, font, "Challenge Mode",
+                        challengeModeButton.x + challengeModeButton.w / 2,
+                        challengeModeButton.y + challengeModeButton.h / 2, buttonColor);
+    draw_label_centered(queue, font, "2 Player",
+                        twoPlayerButton.x + twoPlayerButton.w / 2,
+                        twoPlayerButton.y + twoPlayerButton.h / 2, buttonColor);
 
-// Function to launch another program
-void launchProgram(const char* programPath) {
-    cleanup(); // Clean up SDL resources before executing new program
-
-    // Print debug info
-    printf("Attempting to launch: %s\n", programPath);
-
-    // Execute the program (replace the current process)
-    execl(programPath, programPath, NULL);
+}
 
-    // If execl returns, it failed
-    perror("execl failed");
-    exit(EXIT_FAILURE);
+static bool is_point_in_rect(int x, int y, const SDL_Rect *rect) {
+    return x >= rect->x && x < rect->x + rect->w &&
+           y >= rect->y && y < rect->y + rect->h;
 }
 
-// Handle menu clicks
-void handleMenuEvents() {
+// Handle menu clicks; returns the scene chosen, or SCENE_MENU for none yet
+static Scene handleMenuEvents(void) {
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         if (event.type == SDL_QUIT) {
-            currentGameState = QUIT;
+            return SCENE_QUIT;
         } else if (event.type == SDL_MOUSEBUTTONDOWN) {
             int x = event.button.x;
             int y = event.button.y;
 
-            // Debug print to see where clicks are being registered
-            printf("Mouse click at x=%d, y=%d\n", x, y);
-
-            if (x >= singlePlayerButton.x && x < singlePlayerButton.x + singlePlayerButton.w &&
-                y >= singlePlayerButton.y && y < singlePlayerButton.y + singlePlayerButton.h) {
-                printf("Single Player button clicked!\n");
-                launchProgram("./attempt");
-            } else if (x >= challengeModeButton.x && x < challengeModeButton.x + challengeModeButton.w &&
-                      y >= challengeModeButton.y && y < challengeModeButton.y + challengeModeButton.h) {
-                printf("Challenge Mode button clicked!\n");
-                launchProgram("./challenge");
-            } else if (x >= twoPlayerButton.x && x < twoPlayerButton.x + twoPlayerButton.w &&
-                      y >= twoPlayerButton.y && y < twoPlayerButton.y + twoPlayerButton.h) {
-                printf("Two Player button clicked!\n");
-                launchProgram("./multiplayer");
+            if (is_point_in_rect(x, y, &singlePlayerButton)) {
+                return SCENE_SINGLE_PLAYER;
+            } else if (is_point_in_rect(x, y, &challengeModeButton)) {
+                return SCENE_CHALLENGE;
+            } else if (is_point_in_rect(x, y, &twoPlayerButton)) {
+                return SCENE_MULTIPLAYER;
             }
         }
     }
+    return SCENE_MENU;
+}
+
+Scene run_menu(Host *host, const GameOptions *options) {
+    enter_scene(host, "Snake Game");
+
+    Font *font = host_font(host, "dejavu-fonts-ttf-2.37/ttf/DejaVuSans.ttf", 24, false);
+    if (!font) {
+        printf("Failed to load font! TTF_Error: %s\n", TTF_GetError());
+        printf("Attempted to load font at: dejavu-fonts-ttf-2.37/ttf/DejaVuSans.ttf\n");
+        return SCENE_FAILED;
+    }
+
+    bool firstFrame = true;
+    Scene next = SCENE_MENU;
+    while (next == SCENE_MENU) {
+        TRACE_BEGIN(drawing);
+        renderMenu(&host->queue, font);
+        TRACE_END(drawing, "renderMenu");
+        draw_host_hud(host);
+        TRACE_BEGIN(presenting);
+        present_render_queue(&host->queue);
+        TRACE_END(presenting, "present");
+        if (firstFrame && options->measureStartup) report_first_frame(host, "menu");
+        firstFrame = false;
+
+        TRACE_BEGIN(polling);
+        next = handleMenuEvents();
+        TRACE_END(polling, "poll events");
+
+        // Small delay to prevent CPU hogging in the main loop
+        if (next == SCENE_MENU) {
+            TRACE_BEGIN(sleeping);
+            SDL_Delay(16); // ~60 FPS
+            TRACE_END(sleeping, "SDL_Delay");
+        }
+    }
+    return next;
 }
 
 // Main loop
 int main(int argc, char* argv[]) {
-    if (!init()) {
+    Uint64 launch = SDL_GetPerformanceCounter();
+    GameOptions options;
+    if (!parse_options(&options, &argc, argv)) {
         return 1;
     }
+    if (options.headless) return run_headless(&options, NULL);
 
-    bool running = true;
-    while (running) {
-        switch (currentGameState) {
-            case MENU:
-                renderMenu();
-                handleMenuEvents();
+    Host host;
+    if (!open_host(&host, "Snake Game", &options)) {
+        return 1;
+    }
+    host.sceneStart = launch;
+
+    // With --measure-startup every scene reports the time from the switch
+    // to its first frame
+    Scene scene = SCENE_MENU;
+    int status = 0;
+    while (scene != SCENE_QUIT) {
+        switch (scene) {
+            case SCENE_SINGLE_PLAYER:
+                scene = run_single_player(&host, &options);
                 break;
-            case QUIT:
-                running = false;
+            case SCENE_CHALLENGE:
+                scene = run_challenge(&host, &options);
+                break;
+            case SCENE_MULTIPLAYER:
+                scene = run_multiplayer(&host, &options);
                 break;
             default:
-                // This should not happen with the new implementation
-                printf("Unexpected game state!\n");
-                running = false;
+                scene = run_menu(&host, &options);
+                if (scene == SCENE_FAILED) {
+                    status = 1;
+                    scene = SCENE_QUIT;
+                }
                 break;
         }
 
-        // Small delay to prevent CPU hogging in the main loop
-        SDL_Delay(16); // ~60 FPS
+        // A mode that couldn't start has said why; offer the menu again
+        if (scene == SCENE_FAILED) scene = SCENE_MENU;
+        host.sceneStart = SDL_GetPerformanceCounter();
     }
 
-    cleanup();
-    return 0;
-}
+    close_host(&host);
+    return status;
+}
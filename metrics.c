@@ -0,0 +1,243 @@
+#include "metrics.h"
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define PSAPI_VERSION 2  // K32GetProcessMemoryInfo() from kernel32, no psapi.lib
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+#include "trace.h"
+
+#define FRAME_BUCKETS 8
+#define MAX_FRAME_MICROSECONDS 600000000  // Longer frames (a suspended process) count as this
+#define GAME_MODES 3  // MODE_SINGLE, MODE_CHALLENGE, MODE_MULTI
+
+// Upper bounds of the frame time histogram, and the same as le labels
+static const int bucketMicroseconds[FRAME_BUCKETS] = {5000, 10000, 16700, 20000, 33300, 50000, 100000, 250000};
+static const char *bucketLabels[FRAME_BUCKETS] = {"0.005", "0.01", "0.0167", "0.02", "0.0333", "0.05", "0.1", "0.25"};
+static const char *modeLabels[GAME_MODES] = {"single", "challenge", "multi"};
+
+// Counts since the writer last drained them
+typedef struct {
+    SDL_atomic_t frames;
+    SDL_atomic_t frameBuckets[FRAME_BUCKETS + 1];  // The last one is +Inf
+    SDL_atomic_t frameMicroseconds;
+    SDL_atomic_t ticks;
+    SDL_atomic_t droppedTicks;
+    SDL_atomic_t games[GAME_MODES];
+    SDL_atomic_t scores[GAME_MODES];
+    SDL_atomic_t underruns;
+} MetricCounts;
+
+// The writer thread's running totals
+typedef struct {
+    uint64_t frames;
+    uint64_t frameBuckets[FRAME_BUCKETS + 1];
+    uint64_t frameMicroseconds;
+    uint64_t ticks;
+    uint64_t droppedTicks;
+    uint64_t games[GAME_MODES];
+    uint64_t scores[GAME_MODES];
+    uint64_t underruns;
+} MetricTotals;
+
+// Set before the host starts the audio thread and cleared after it has
+// stopped it, so every thread that counts sees it settled
+static bool metricsEnabled = false;
+
+static MetricCounts counts;
+static MetricTotals totals;
+static const char *metricsPath;
+static char tempPath[1024];
+static SDL_Thread *writer;
+static SDL_sem *stopSignal;
+static Uint64 lastFrame;  // Game thread only
+
+static uint64_t drain(SDL_atomic_t *counter) {
+    return (unsigned)SDL_AtomicSet(counter, 0);
+}
+
+// Bytes resident, or 0 where there is no cheap way to ask
+static uint64_t resident_memory(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS memory;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory))) return memory.WorkingSetSize;
+    return 0;
+#elif defined(__linux__)
+    unsigned long size, resident;
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (!file) return 0;
+    int read = fscanf(file, "%lu %lu", &size, &resident);
+    fclose(file);
+    return read == 2 ? (uint64_t)resident * (uint64_t)sysconf(_SC_PAGESIZE) : 0;
+#else
+    return 0;
+#endif
+}
+
+static void write_counter(FILE *file, const char *name, const char *help, uint64_t value) {
+    fprintf(file, "# HELP %s %s\n# TYPE %s counter\n%s %llu\n", name, help, name, name,
+            (unsigned long long)value);
+}
+
+static void write_metrics(void) {
+    TRACE_BEGIN(writing);
+    totals.frames += drain(&counts.frames);
+    for (int i = 0; i <= FRAME_BUCKETS; i++) totals.frameBuckets[i] += drain(&counts.frameBuckets[i]);
+    totals.frameMicroseconds += drain(&counts.frameMicroseconds);
+    totals.ticks += drain(&counts.ticks);
+    totals.droppedTicks += drain(&counts.droppedTicks);
+    for (int i = 0; i < GAME_MODES; i++) {
+        totals.games[i] += drain(&counts.games[i]);
+        totals.scores[i] += drain(&counts.scores[i]);
+    }
+    totals.underruns += drain(&counts.underruns);
+
+    FILE *file = fopen(tempPath, "w");
+    if (!file) {
+        TRACE_END(writing, "write metrics");
+        return;
+    }
+
+    write_counter(file, "snake_frames_total", "Frames presented.", totals.frames);
+
+    // Prometheus buckets count everything at or below their bound
+    fprintf(file, "# HELP snake_frame_seconds Time from one present to the next.\n");
+    fprintf(file, "# TYPE snake_frame_seconds histogram\n");
+    uint64_t cumulative = 0;
+    for (int i = 0; i < FRAME_BUCKETS; i++) {
+        cumulative += totals.frameBuckets[i];
+        fprintf(file, "snake_frame_seconds_bucket{le=\"%s\"} %llu\n", bucketLabels[i],
+                (unsigned long long)cumulative);
+    }
+    cumulative += totals.frameBuckets[FRAME_BUCKETS];
+    fprintf(file, "snake_frame_seconds_bucket{le=\"+Inf\"} %llu\n", (unsigned long long)cumulative);
+    fprintf(file, "snake_frame_seconds_sum %.6f\n", totals.frameMicroseconds / 1e6);
+    fprintf(file, "snake_frame_seconds_count %llu\n", (unsigned long long)cumulative);
+
+    write_counter(file, "snake_ticks_total", "Simulation ticks run.", totals.ticks);
+    write_counter(file, "snake_dropped_ticks_total", "Ticks given up to catch up after a stall.",
+                  totals.droppedTicks);
+
+    fprintf(file, "# HELP snake_games_total Games finished.\n# TYPE snake_games_total counter\n");
+    for (int i = 0; i < GAME_MODES; i++) {
+        fprintf(file, "snake_games_total{mode=\"%s\"} %llu\n", modeLabels[i],
+                (unsigned long long)totals.games[i]);
+    }
+    fprintf(file, "# HELP snake_score_total Scores of the games finished, added up.\n");
+    fprintf(file, "# TYPE snake_score_total counter\n");
+    for (int i = 0; i < GAME_MODES; i++) {
+        fprintf(file, "snake_score_total{mode=\"%s\"} %llu\n", modeLabels[i],
+                (unsigned long long)totals.scores[i]);
+    }
+    fprintf(file, "# HELP snake_average_score Mean score of the games finished.\n");
+    fprintf(file, "# TYPE snake_average_score gauge\n");
+    for (int i = 0; i < GAME_MODES; i++) {
+        if (totals.games[i] > 0) {
+            fprintf(file, "snake_average_score{mode=\"%s\"} %.2f\n", modeLabels[i],
+                    (double)totals.scores[i] / totals.games[i]);
+        } else {
+            fprintf(file, "snake_average_score{mode=\"%s\"} NaN\n", modeLabels[i]);
+        }
+    }
+
+    write_counter(file, "snake_audio_underruns_total", "Mixer buffers that came too late to play on time.",
+                  totals.underruns);
+
+    uint64_t resident = resident_memory();
+    if (resident > 0) {
+        fprintf(file, "# HELP process_resident_memory_bytes Resident memory size in bytes.\n");
+        fprintf(file, "# TYPE process_resident_memory_bytes gauge\n");
+        fprintf(file, "process_resident_memory_bytes %llu\n", (unsigned long long)resident);
+    }
+
+    bool written = fclose(file) == 0;
+#ifdef _WIN32
+    if (written) MoveFileExA(tempPath, metricsPath, MOVEFILE_REPLACE_EXISTING);
+#else
+    if (written) rename(tempPath, metricsPath);
+#endif
+    TRACE_END(writing, "write metrics");
+}
+
+static int write_metrics_loop(void *data) {
+    (void)data;
+    trace_thread_name("metrics");
+    while (SDL_SemWaitTimeout(stopSignal, METRICS_INTERVAL_MS) == SDL_MUTEX_TIMEDOUT) {
+        write_metrics();
+    }
+    write_metrics();
+    return 0;
+}
+
+bool start_metrics(const char *path) {
+    if (snprintf(tempPath, sizeof(tempPath), "%s.tmp", path) >= (int)sizeof(tempPath)) {
+        printf("--metrics file name is too long\n");
+        return false;
+    }
+    metricsPath = path;
+    memset(&counts, 0, sizeof(counts));
+    memset(&totals, 0, sizeof(totals));
+    lastFrame = 0;
+
+    stopSignal = SDL_CreateSemaphore(0);
+    writer = stopSignal ? SDL_CreateThread(write_metrics_loop, "metrics", NULL) : NULL;
+    if (!writer) {
+        printf("Could not start the metrics writer! SDL_Error: %s\n", SDL_GetError());
+        if (stopSignal) SDL_DestroySemaphore(stopSignal);
+        stopSignal = NULL;
+        return false;
+    }
+    metricsEnabled = true;
+    return true;
+}
+
+void stop_metrics(void) {
+    if (!writer) return;
+    metricsEnabled = false;
+    SDL_SemPost(stopSignal);
+    SDL_WaitThread(writer, NULL);
+    SDL_DestroySemaphore(stopSignal);
+    writer = NULL;
+    stopSignal = NULL;
+}
+
+void count_frame(void) {
+    if (!metricsEnabled) return;
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (lastFrame != 0) {
+        Uint64 elapsed = (now - lastFrame) * 1000000 / SDL_GetPerformanceFrequency();
+        int microseconds = elapsed < MAX_FRAME_MICROSECONDS ? (int)elapsed : MAX_FRAME_MICROSECONDS;
+        int bucket = 0;
+        while (bucket < FRAME_BUCKETS && microseconds > bucketMicroseconds[bucket]) bucket++;
+        SDL_AtomicAdd(&counts.frameBuckets[bucket], 1);
+        SDL_AtomicAdd(&counts.frameMicroseconds, microseconds);
+    }
+    lastFrame = now;
+    SDL_AtomicAdd(&counts.frames, 1);
+}
+
+void count_tick(void) {
+    if (metricsEnabled) SDL_AtomicAdd(&counts.ticks, 1);
+}
+
+void count_dropped_ticks(int ticks) {
+    if (metricsEnabled) SDL_AtomicAdd(&counts.droppedTicks, ticks);
+}
+
+void count_game(GameMode mode, int score) {
+    if (!metricsEnabled || (int)mode < 0 || (int)mode >= GAME_MODES) return;
+    SDL_AtomicAdd(&counts.games[mode], 1);
+    SDL_AtomicAdd(&counts.scores[mode], score);
+}
+
+void count_audio_underrun(void) {
+    if (metricsEnabled) SDL_AtomicAdd(&counts.underruns, 1);
+}
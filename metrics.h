@@ -0,0 +1,52 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdbool.h>
+
+#include "snake_sim.h"
+
+// Runtime metrics for --metrics FILE, for machines left running the game
+// unattended. The game counts frames, ticks and finished games, and the
+// audio thread counts underruns, each with one atomic add into a 32-bit
+// counter. A background thread drains the counters into 64-bit totals of
+// its own every METRICS_INTERVAL_MS and rewrites FILE with them in the
+// Prometheus text exposition format, so the game thread never touches the
+// file and no counter lives long enough to wrap.
+//
+// FILE is written as FILE.tmp and renamed over, so a reader never sees it
+// half written. Named *.prom it can go straight into node_exporter's
+// textfile collector directory; scrape_metrics.py reads it without any
+// service at all.
+//
+// Exported:
+//     snake_frames_total                 frames presented
+//     snake_frame_seconds                histogram of present-to-present time
+//     snake_ticks_total                  simulation ticks run
+//     snake_dropped_ticks_total          ticks given up to catch up after a
+//                                        stall (challenge mode; the others
+//                                        run late ticks late instead)
+//     snake_games_total{mode}            games finished
+//     snake_score_total{mode}            their scores added up
+//     snake_average_score{mode}          the mean, NaN before the first game
+//     snake_audio_underruns_total        mixer buffers that came too late
+//     process_resident_memory_bytes      on Linux and Windows
+
+#define METRICS_INTERVAL_MS 5000
+
+// Start the writer thread. Until then, and after stop_metrics(), counting
+// does nothing. Prints a message and returns false if it can't start.
+bool start_metrics(const char *path);
+
+// Write FILE a last time and stop the writer
+void stop_metrics(void);
+
+// Call just before every present; the time between calls is the frame time
+void count_frame(void);
+void count_tick(void);
+void count_dropped_ticks(int ticks);
+void count_game(GameMode mode, int score);
+
+// From the audio thread
+void count_audio_underrun(void);
+
+#endif
@@ -0,0 +1,258 @@
+#include "options.h"
+#include "snake_sim.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Strip leading and trailing whitespace in place
+static char *trim(char *text) {
+    while (isspace((unsigned char)*text)) text++;
+
+    char *end = text + strlen(text);
+    while (end > text && isspace((unsigned char)end[-1])) end--;
+    *end = '\0';
+
+    return text;
+}
+
+static bool parse_board(GameOptions *options, const char *value, const char *source) {
+    int width, height;
+    char extra;
+
+    if (sscanf(value, "%dx%d%c", &width, &height, &extra) != 2 ||
+        width < MIN_GRID_WIDTH || width > MAX_GRID_SIZE ||
+        height < MIN_GRID_HEIGHT || height > MAX_GRID_SIZE) {
+        printf("%s: board must be WIDTHxHEIGHT from %dx%d to %dx%d, got \"%s\"\n",
+               source, MIN_GRID_WIDTH, MIN_GRID_HEIGHT, MAX_GRID_SIZE, MAX_GRID_SIZE, value);
+        return false;
+    }
+
+    options->boardWidth = width;
+    options->boardHeight = height;
+    return true;
+}
+
+static bool parse_seed(GameOptions *options, const char *value) {
+    unsigned long long seed;
+    char extra;
+
+    if (sscanf(value, "%llu%c", &seed, &extra) != 1 || value[0] == '-') {
+        printf("--seed must be a non-negative integer, got \"%s\"\n", value);
+        return false;
+    }
+
+    options->hasSeed = true;
+    options->seed = seed;
+    return true;
+}
+
+static bool parse_audio_buffer(GameOptions *options, const char *value, const char *source) {
+    int samples;
+    char extra;
+
+    if (sscanf(value, "%d%c", &samples, &extra) != 1 || samples < MIN_AUDIO_BUFFER ||
+        samples > MAX_AUDIO_BUFFER || (samples & (samples - 1)) != 0) {
+        printf("%s: audio buffer must be a power of two from %d to %d samples, got \"%s\"\n",
+               source, MIN_AUDIO_BUFFER, MAX_AUDIO_BUFFER, value);
+        return false;
+    }
+
+    options->audioBuffer = samples;
+    return true;
+}
+
+static bool parse_count(const char *value, const char *source, long max, long *count) {
+    long parsed;
+    char extra;
+
+    if (sscanf(value, "%ld%c", &parsed, &extra) != 1 || parsed < 1 || parsed > max) {
+        printf("%s must be a whole number from 1 to %ld, got \"%s\"\n", source, max, value);
+        return false;
+    }
+
+    *count = parsed;
+    return true;
+}
+
+static bool parse_matches(GameOptions *options, const char *value) {
+    long count;
+    if (!parse_count(value, "--matches", 1000000, &count)) return false;
+    options->matches = (int)count;
+    return true;
+}
+
+static bool parse_max_ticks(GameOptions *options, const char *value) {
+    long count;
+    if (!parse_count(value, "--max-ticks", 1000000000, &count)) return false;
+    options->maxTicks = (unsigned)count;
+    return true;
+}
+
+static bool load_config(GameOptions *options) {
+    FILE *file = fopen(CONFIG_FILE, "r");
+    if (!file) return true; // No config file, keep the defaults
+
+    char line[256];
+    bool ok = true;
+
+    while (ok && fgets(line, sizeof(line), file)) {
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        char *equals = strchr(line, '=');
+        if (!equals) {
+            if (*trim(line) != '\0') {
+                printf("%s: ignoring \"%s\"\n", CONFIG_FILE, trim(line));
+            }
+            continue;
+        }
+
+        *equals = '\0';
+        char *key = trim(line);
+        char *value = trim(equals + 1);
+
+        if (strcmp(key, "board") == 0) {
+            ok = parse_board(options, value, CONFIG_FILE);
+        } else if (strcmp(key, "audio_buffer") == 0) {
+            ok = parse_audio_buffer(options, value, CONFIG_FILE);
+        } else {
+            printf("%s: unknown setting \"%s\"\n", CONFIG_FILE, key);
+        }
+    }
+
+    fclose(file);
+    return ok;
+}
+
+bool parse_options(GameOptions *options, int *argc, char *argv[]) {
+    options->boardWidth = DEFAULT_GRID_WIDTH;
+    options->boardHeight = DEFAULT_GRID_HEIGHT;
+    options->hasSeed = false;
+    options->seed = 0;
+    options->recordPath = NULL;
+    options->measureTicks = false;
+    options->measureStartup = false;
+    options->audioBuffer = DEFAULT_AUDIO_BUFFER;
+    options->measureAudio = false;
+    options->headless = false;
+    options->agentName = DEFAULT_AGENT;
+    options->replayPath = NULL;
+    options->matches = 1;
+    options->maxTicks = DEFAULT_MAX_TICKS;
+    options->tracePath = NULL;
+    options->metricsPath = NULL;
+
+    if (!load_config(options)) return false;
+
+    // Compact argv over the options we consume
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        const char *arg = argv[i];
+
+        if (strcmp(arg, "--board") == 0) {
+            if (i + 1 >= *argc) {
+                printf("--board needs a value, e.g. --board 64x48\n");
+                return false;
+            }
+            if (!parse_board(options, argv[++i], "--board")) return false;
+        } else if (strncmp(arg, "--board=", 8) == 0) {
+            if (!parse_board(options, arg + 8, "--board")) return false;
+        } else if (strcmp(arg, "--seed") == 0) {
+            if (i + 1 >= *argc) {
+                printf("--seed needs a value, e.g. --seed 42\n");
+                return false;
+            }
+            if (!parse_seed(options, argv[++i])) return false;
+        } else if (strncmp(arg, "--seed=", 7) == 0) {
+            if (!parse_seed(options, arg + 7)) return false;
+        } else if (strcmp(arg, "--record") == 0) {
+            if (i + 1 >= *argc) {
+                printf("--record needs a file name, e.g. --record match.rpl\n");
+                return false;
+            }
+            options->recordPath = argv[++i];
+        } else if (strncmp(arg, "--record=", 9) == 0) {
+            options->recordPath = arg + 9;
+        } else if (strcmp(arg, "--trace") == 0) {
+            if (i + 1 >= *argc) {
+                printf("--trace needs a file name, e.g. --trace trace.json\n");
+                return false;
+            }
+            options->tracePath = argv[++i];
+        } else if (strncmp(arg, "--trace=", 8) == 0) {
+            options->tracePath = arg + 8;
+        } else if (strcmp(arg, "--metrics") == 0) {
+            if (i + 1 >= *argc) {
+                printf("--metrics needs a file name, e.g. --metrics snake.prom\n");
+                return false;
+            }
+            options->metricsPath = argv[++i];
+        } else if (strncmp(arg, "--metrics=", 10) == 0) {
+            options->metricsPath = arg + 10;
+        } else if (strcmp(arg, "--measure-ticks") == 0) {
+            options->measureTicks = true;
+        } else if (strcmp(arg, "--measure-startup") == 0) {
+            options->measureStartup = true;
+        } else if (strcmp(arg, "--audio-buffer") == 0) {
+            if (i + 1 >= *argc) {
+                printf("--audio-buffer needs a value, e.g. --audio-buffer 256\n");
+                return false;
+            }
+            if (!parse_audio_buffer(options, argv[++i], "--audio-buffer")) return false;
+        } else if (strncmp(arg, "--audio-buffer=", 15) == 0) {
+            if (!parse_audio_buffer(options, arg + 15, "--audio-buffer")) return false;
+        } else if (strcmp(arg, "--measure-audio") == 0) {
+            options->measureAudio = true;
+        } else if (strcmp(arg, "--headless") == 0) {
+            options->headless = true;
+        } else if (strcmp(arg, "--agent") == 0) {
+            if (i + 1 >= *argc) {
+                printf("--agent needs a name, e.g. --agent greedy\n");
+                return false;
+            }
+            options->agentName = argv[++i];
+        } else if (strncmp(arg, "--agent=", 8) == 0) {
+            options->agentName = arg + 8;
+        } else if (strcmp(arg, "--replay") == 0) {
+            if (i + 1 >= *argc) {
+                printf("--replay needs a file name, e.g. --replay match.rpl\n");
+                return false;
+            }
+            options->replayPath = argv[++i];
+        } else if (strncmp(arg, "--replay=", 9) == 0) {
+            options->replayPath = arg + 9;
+        } else if (strcmp(arg, "--matches") == 0) {
+            if (i + 1 >= *argc) {
+                printf("--matches needs a value, e.g. --matches 100\n");
+                return false;
+            }
+            if (!parse_matches(options, argv[++i])) return false;
+        } else if (strncmp(arg, "--matches=", 10) == 0) {
+            if (!parse_matches(options, arg + 10)) return false;
+        } else if (strcmp(arg, "--max-ticks") == 0) {
+            if (i + 1 >= *argc) {
+                printf("--max-ticks needs a value, e.g. --max-ticks 100000\n");
+                return false;
+            }
+            if (!parse_max_ticks(options, argv[++i])) return false;
+        } else if (strncmp(arg, "--max-ticks=", 12) == 0) {
+            if (!parse_max_ticks(options, arg + 12)) return false;
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+
+    *argc = kept;
+    argv[kept] = NULL;
+    return true;
+}
+
+uint64_t choose_seed(const GameOptions *options) {
+    if (options->hasSeed) return options->seed;
+
+    uint64_t seed = (uint64_t)time(NULL);
+    printf("Seed %llu (replay with --seed %llu)\n", (unsigned long long)seed, (unsigned long long)seed);
+    return seed;
+}
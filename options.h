@@ -0,0 +1,84 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Settings shared by every game binary, read from CONFIG_FILE and then the
+// command line (which wins).
+//
+// Config file, one setting per line, '#' starts a comment:
+//     board = 64x48
+//     audio_buffer = 256
+//
+// Command line:
+//     --board WIDTHxHEIGHT   (or --board=WIDTHxHEIGHT)
+//     --seed N               (or --seed=N) fixed random seed, to replay a game
+//     --record FILE          (or --record=FILE) save each finished match to
+//                            FILE as a replay (see replay.h), overwriting the
+//                            previous one
+//     --measure-ticks        report the achieved tick rate and jitter, and
+//                            renderer calls per frame (challenge mode)
+//     --measure-startup      report the time from launch, and in the launcher
+//                            from each mode switch, to the first frame
+//     --audio-buffer N       (or --audio-buffer=N) mixer buffer in samples, a
+//                            power of two from 256 to 8192; smaller buffers
+//                            mean less sound latency but risk dropouts
+//     --measure-audio        report the latency from a sound being played to
+//                            the mixer picking it up, on exit
+//     --headless             play matches with no window, renderer or audio
+//                            device, as fast as they run (see headless.h)
+//     --agent NAME           (or --agent=NAME) who plays headless matches
+//     --replay FILE          (or --replay=FILE) play a recording headless
+//                            instead
+//     --matches N            (or --matches=N) headless matches to play
+//     --max-ticks N          (or --max-ticks=N) end a headless match after N
+//                            ticks if it is still going
+//     --trace FILE           (or --trace=FILE) record a timeline of every
+//                            frame and tick, written to FILE on F9 and on
+//                            exit (see trace.h)
+//     --metrics FILE         (or --metrics=FILE) keep FILE up to date with
+//                            runtime metrics in the Prometheus text format
+//                            (see metrics.h)
+
+#define CONFIG_FILE "snake.cfg"
+
+#define DEFAULT_AGENT "greedy"
+#define DEFAULT_MAX_TICKS 100000
+
+#define DEFAULT_AUDIO_BUFFER 512  // About 12 ms at 44.1 kHz
+#define MIN_AUDIO_BUFFER 256
+#define MAX_AUDIO_BUFFER 8192
+
+typedef struct {
+    int boardWidth;
+    int boardHeight;
+    bool hasSeed;  // --seed given; otherwise each binary picks its own
+    uint64_t seed;
+    const char *recordPath; // --record, NULL when not recording
+    bool measureTicks;
+    bool measureStartup;
+    int audioBuffer;  // Samples per mixer buffer
+    bool measureAudio;
+
+    bool headless;
+    const char *agentName;  // Checked when the headless run starts
+    const char *replayPath; // NULL when agents play
+    int matches;
+    unsigned maxTicks;
+
+    const char *tracePath;  // NULL when not tracing
+    const char *metricsPath;  // NULL when not exporting metrics
+} GameOptions;
+
+// Fill in the defaults, apply CONFIG_FILE if it exists, then the options
+// on the command line. Recognized options are removed from argv (and argc
+// updated) so the caller can handle whatever is left. Prints a message and
+// returns false on a malformed or out-of-range value.
+bool parse_options(GameOptions *options, int *argc, char *argv[]);
+
+// The seed for a new game: the --seed value, or one taken from the clock.
+// A clock seed is printed so the game can be replayed with --seed.
+uint64_t choose_seed(const GameOptions *options);
+
+#endif
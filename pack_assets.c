@@ -0,0 +1,367 @@
+// Offline packer for the asset pack described in asset_pack.h.
+//
+// Build: gcc -O2 -o pack_assets pack_assets.c -lSDL2 -lSDL2_image
+// Usage: pack_assets [--sprite-size N] OUTPUT FILE...
+//
+// .png files become sprites in the atlas, .wav files sounds and .ttf files
+// fonts, each found by its file name. Sprites bigger than N pixels either
+// way (default: the largest cell the board view draws) are box-filtered
+// down to fit, since the game never draws them any bigger; 0 keeps them at
+// full size. The pack the game looks for is built with
+//
+//     pack_assets assets.pak apple.png banana.png grapes.png apple_eat.wav obstacle_hit.wav DejaVuSans.ttf
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "asset_pack.h"
+#include "board_view.h"
+
+#define ATLAS_WIDTH 256
+#define MAX_ASSETS 64
+
+typedef struct {
+    char name[ASSET_NAME_LENGTH];
+    AssetType type;
+    SDL_Surface *surface;   // Sprites, RGBA32 at the packed size
+    unsigned char *data;    // Sounds and fonts, as written to the pack
+    size_t size;
+    SDL_Rect rect;          // Sprites: place in the atlas
+} Asset;
+
+static size_t align(size_t offset) {
+    return (offset + ASSET_ALIGNMENT - 1) / ASSET_ALIGNMENT * ASSET_ALIGNMENT;
+}
+
+static void put16(unsigned char *out, unsigned value) {
+    out[0] = value & 0xff;
+    out[1] = (value >> 8) & 0xff;
+}
+
+static void put32(unsigned char *out, uint32_t value) {
+    put16(out, value & 0xffff);
+    put16(out + 2, value >> 16);
+}
+
+static bool has_extension(const char *path, const char *extension) {
+    size_t length = strlen(path), ext_length = strlen(extension);
+    return length > ext_length && SDL_strcasecmp(path + length - ext_length, extension) == 0;
+}
+
+// --- Sprites ---
+
+// Box-filter `source` (RGBA32) down to width x height. Colour is averaged
+// weighted by alpha so transparent pixels don't darken the edges.
+static SDL_Surface *shrink(SDL_Surface *source, int width, int height) {
+    SDL_Surface *result = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!result) return NULL;
+
+    for (int y = 0; y < height; y++) {
+        int y0 = y * source->h / height, y1 = (y + 1) * source->h / height;
+        if (y1 == y0) y1 = y0 + 1;
+
+        for (int x = 0; x < width; x++) {
+            int x0 = x * source->w / width, x1 = (x + 1) * source->w / width;
+            if (x1 == x0) x1 = x0 + 1;
+
+            double r = 0, g = 0, b = 0, a = 0;
+            for (int sy = y0; sy < y1; sy++) {
+                const Uint8 *row = (const Uint8 *)source->pixels + sy * source->pitch;
+                for (int sx = x0; sx < x1; sx++) {
+                    const Uint8 *p = row + sx * 4;
+                    r += p[0] * p[3];
+                    g += p[1] * p[3];
+                    b += p[2] * p[3];
+                    a += p[3];
+                }
+            }
+
+            Uint8 *out = (Uint8 *)result->pixels + y * result->pitch + x * 4;
+            int count = (x1 - x0) * (y1 - y0);
+            out[0] = a > 0 ? (Uint8)(r / a + 0.5) : 0;
+            out[1] = a > 0 ? (Uint8)(g / a + 0.5) : 0;
+            out[2] = a > 0 ? (Uint8)(b / a + 0.5) : 0;
+            out[3] = (Uint8)(a / count + 0.5);
+        }
+    }
+    return result;
+}
+
+static bool load_sprite_file(Asset *asset, const char *path, int max_size) {
+    SDL_Surface *image = IMG_Load(path);
+    if (!image) {
+        printf("%s: %s\n", path, IMG_GetError());
+        return false;
+    }
+    asset->surface = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(image);
+    if (!asset->surface) {
+        printf("%s: %s\n", path, SDL_GetError());
+        return false;
+    }
+
+    int width = asset->surface->w, height = asset->surface->h;
+    if (max_size > 0 && width > max_size) width = max_size;
+    if (max_size > 0 && height > max_size) height = max_size;
+
+    if (width != asset->surface->w || height != asset->surface->h) {
+        SDL_Surface *small = shrink(asset->surface, width, height);
+        SDL_FreeSurface(asset->surface);
+        asset->surface = small;
+        if (!small) {
+            printf("%s: %s\n", path, SDL_GetError());
+            return false;
+        }
+    }
+    return true;
+}
+
+// Shelf-pack the sprites with a one pixel gap, as the font atlas does.
+// Returns the atlas height.
+static int place_sprites(Asset *assets, int count, int atlas_width) {
+    int x = 0, y = 0, row_height = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (assets[i].type != ASSET_SPRITE) continue;
+        SDL_Surface *surface = assets[i].surface;
+
+        if (x + surface->w > atlas_width) {
+            x = 0;
+            y += row_height + 1;
+            row_height = 0;
+        }
+        assets[i].rect = (SDL_Rect){x, y, surface->w, surface->h};
+        x += surface->w + 1;
+        if (surface->h > row_height) row_height = surface->h;
+    }
+    return y + row_height;
+}
+
+// --- Sounds and fonts ---
+
+// Convert to the pack's sound format and wrap the PCM in a WAV header, so
+// the game can hand it to the mixer either way
+static bool load_sound_file(Asset *asset, const char *path) {
+    SDL_AudioSpec spec;
+    Uint8 *pcm;
+    Uint32 length;
+    if (!SDL_LoadWAV(path, &spec, &pcm, &length)) {
+        printf("%s: %s\n", path, SDL_GetError());
+        return false;
+    }
+
+    SDL_AudioCVT cvt;
+    if (SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq,
+                          PACK_SOUND_FORMAT, PACK_SOUND_CHANNELS, PACK_SOUND_FREQUENCY) < 0) {
+        printf("%s: %s\n", path, SDL_GetError());
+        SDL_FreeWAV(pcm);
+        return false;
+    }
+
+    cvt.len = (int)length;
+    cvt.buf = malloc((size_t)length * cvt.len_mult);
+    if (!cvt.buf) {
+        printf("%s: out of memory\n", path);
+        SDL_FreeWAV(pcm);
+        return false;
+    }
+    memcpy(cvt.buf, pcm, length);
+    SDL_FreeWAV(pcm);
+
+    if (cvt.needed && SDL_ConvertAudio(&cvt) != 0) {
+        printf("%s: %s\n", path, SDL_GetError());
+        free(cvt.buf);
+        return false;
+    }
+    size_t pcm_size = cvt.needed ? (size_t)cvt.len_cvt : length;
+
+    asset->size = WAV_HEADER_SIZE + pcm_size;
+    asset->data = malloc(asset->size);
+    if (!asset->data) {
+        printf("%s: out of memory\n", path);
+        free(cvt.buf);
+        return false;
+    }
+
+    unsigned char *h = asset->data;
+    int frame = PACK_SOUND_CHANNELS * (int)SDL_AUDIO_BITSIZE(PACK_SOUND_FORMAT) / 8;
+    memcpy(h, "RIFF", 4);
+    put32(h + 4, (uint32_t)(asset->size - 8));
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put32(h + 16, 16);
+    put16(h + 20, 1); // PCM
+    put16(h + 22, PACK_SOUND_CHANNELS);
+    put32(h + 24, PACK_SOUND_FREQUENCY);
+    put32(h + 28, PACK_SOUND_FREQUENCY * frame);
+    put16(h + 32, frame);
+    put16(h + 34, SDL_AUDIO_BITSIZE(PACK_SOUND_FORMAT));
+    memcpy(h + 36, "data", 4);
+    put32(h + 40, (uint32_t)pcm_size);
+    memcpy(h + WAV_HEADER_SIZE, cvt.buf, pcm_size);
+
+    free(cvt.buf);
+    return true;
+}
+
+static bool load_data_file(Asset *asset, const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        printf("%s: cannot open\n", path);
+        return false;
+    }
+
+    bool ok = fseek(file, 0, SEEK_END) == 0;
+    long length = ok ? ftell(file) : -1;
+    ok = length > 0 && fseek(file, 0, SEEK_SET) == 0;
+    if (ok) {
+        asset->size = (size_t)length;
+        asset->data = malloc(asset->size);
+        ok = asset->data && fread(asset->data, 1, asset->size, file) == asset->size;
+    }
+    fclose(file);
+
+    if (!ok) printf("%s: cannot read\n", path);
+    return ok;
+}
+
+// --- Writing ---
+
+static bool write_pack(const char *path, Asset *assets, int count) {
+    // The atlas is at least as wide as the widest sprite
+    int atlas_width = 0;
+    bool has_sprites = false;
+    for (int i = 0; i < count; i++) {
+        if (assets[i].type != ASSET_SPRITE) continue;
+        has_sprites = true;
+        if (assets[i].surface->w > atlas_width) atlas_width = assets[i].surface->w;
+    }
+    if (has_sprites && atlas_width < ATLAS_WIDTH) atlas_width = ATLAS_WIDTH;
+    int atlas_height = has_sprites ? place_sprites(assets, count, atlas_width) : 0;
+
+    PackHeader header = {0};
+    header.magic = ASSET_PACK_MAGIC;
+    header.version = ASSET_PACK_VERSION;
+    header.entryCount = (uint32_t)count;
+    header.atlasWidth = (uint32_t)atlas_width;
+    header.atlasHeight = (uint32_t)atlas_height;
+    header.soundFrequency = PACK_SOUND_FREQUENCY;
+    header.soundFormat = PACK_SOUND_FORMAT;
+    header.soundChannels = PACK_SOUND_CHANNELS;
+
+    size_t offset = align(sizeof(PackHeader) + count * sizeof(PackEntry));
+    header.atlasOffset = (uint32_t)offset;
+    offset = align(offset + (size_t)atlas_width * atlas_height * 4);
+
+    PackEntry entries[MAX_ASSETS] = {0};
+    for (int i = 0; i < count; i++) {
+        PackEntry *entry = &entries[i];
+        memcpy(entry->name, assets[i].name, ASSET_NAME_LENGTH);
+        entry->type = assets[i].type;
+
+        if (assets[i].type == ASSET_SPRITE) {
+            entry->x = assets[i].rect.x;
+            entry->y = assets[i].rect.y;
+            entry->w = assets[i].rect.w;
+            entry->h = assets[i].rect.h;
+        } else {
+            entry->offset = (uint32_t)offset;
+            entry->size = (uint32_t)assets[i].size;
+            offset = align(offset + assets[i].size);
+        }
+    }
+    size_t total = offset;
+
+    unsigned char *pack = calloc(1, total);
+    if (!pack) {
+        printf("%s: out of memory\n", path);
+        return false;
+    }
+    memcpy(pack, &header, sizeof(PackHeader));
+    memcpy(pack + sizeof(PackHeader), entries, count * sizeof(PackEntry));
+
+    for (int i = 0; i < count; i++) {
+        if (assets[i].type == ASSET_SPRITE) {
+            SDL_Surface *surface = assets[i].surface;
+            for (int y = 0; y < surface->h; y++) {
+                unsigned char *row = pack + header.atlasOffset +
+                                     ((size_t)(assets[i].rect.y + y) * atlas_width + assets[i].rect.x) * 4;
+                memcpy(row, (Uint8 *)surface->pixels + y * surface->pitch, (size_t)surface->w * 4);
+            }
+        } else {
+            memcpy(pack + entries[i].offset, assets[i].data, assets[i].size);
+        }
+    }
+
+    FILE *file = fopen(path, "wb");
+    bool ok = file && fwrite(pack, 1, total, file) == total;
+    if (file && fclose(file) != 0) ok = false;
+    free(pack);
+
+    if (!ok) {
+        printf("%s: cannot write\n", path);
+        return false;
+    }
+    printf("%s: %d assets, %dx%d atlas, %zu bytes\n", path, count, atlas_width, atlas_height, total);
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    int max_size = CELL_SIZE * 2;
+    int first = 1;
+
+    if (argc > 2 && strcmp(argv[1], "--sprite-size") == 0) {
+        max_size = atoi(argv[2]);
+        first = 3;
+    }
+    if (argc - first < 2 || argc - first - 1 > MAX_ASSETS || max_size < 0) {
+        printf("Usage: %s [--sprite-size N] OUTPUT FILE...  (up to %d files)\n", argv[0], MAX_ASSETS);
+        return 1;
+    }
+
+    const char *output = argv[first];
+    Asset assets[MAX_ASSETS] = {0};
+    int count = 0;
+    bool ok = true;
+
+    for (int i = first + 1; ok && i < argc; i++) {
+        const char *path = argv[i];
+        Asset *asset = &assets[count++];
+
+        const char *name = path;
+        for (const char *c = path; *c; c++) {
+            if (*c == '/' || *c == '\\') name = c + 1;
+        }
+        if (strlen(name) >= ASSET_NAME_LENGTH) {
+            printf("%s: file name longer than %d characters\n", path, ASSET_NAME_LENGTH - 1);
+            ok = false;
+            break;
+        }
+        strcpy(asset->name, name);
+
+        if (has_extension(path, ".png")) {
+            asset->type = ASSET_SPRITE;
+            ok = load_sprite_file(asset, path, max_size);
+        } else if (has_extension(path, ".wav")) {
+            asset->type = ASSET_SOUND;
+            ok = load_sound_file(asset, path);
+        } else if (has_extension(path, ".ttf")) {
+            asset->type = ASSET_FONT;
+            ok = load_data_file(asset, path);
+        } else {
+            printf("%s: expected a .png, .wav or .ttf file\n", path);
+            ok = false;
+        }
+    }
+
+    if (ok) ok = write_pack(output, assets, count);
+
+    for (int i = 0; i < count; i++) {
+        SDL_FreeSurface(assets[i].surface);
+        free(assets[i].data);
+    }
+    IMG_Quit();
+    return ok ? 0 : 1;
+}
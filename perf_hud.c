@@ -0,0 +1,116 @@
+#include "perf_hud.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board_view.h"
+
+#define HUD_PADDING 8
+#define HUD_BAR_WIDTH 2
+#define HUD_GRAPH_HEIGHT 40
+#define HUD_GRAPH_MS 40.0f      // Frame time at the top of the graph
+#define HUD_TARGET_MS 16.67f    // One frame at 60 Hz, marked on the graph
+#define HUD_WIDTH (PERF_HUD_FRAMES * HUD_BAR_WIDTH + 2 * HUD_PADDING)
+#define HUD_TEXT_LINES 3
+
+static int compare_floats(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of the sorted times
+static float percentile(const float *sorted, int count, int p) {
+    int rank = (p * count + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+// The overlay sits in the top-right corner of the board, clear of the UI
+// bar and of the buttons every scene centres in the window
+static void draw_overlay(PerfHud *hud, RenderQueue *queue, Font *font) {
+    int lineHeight = font ? font->height : 0;
+    SDL_Rect panel = {WINDOW_WIDTH - HUD_WIDTH - UI_PADDING, UI_HEIGHT + UI_PADDING, HUD_WIDTH,
+                      3 * HUD_PADDING + HUD_TEXT_LINES * lineHeight + HUD_GRAPH_HEIGHT};
+
+    set_queue_layer(queue, LAYER_PANEL);
+    set_queue_color(queue, 20, 20, 20, 255);
+    queue_fill_rect(queue, &panel);
+    set_queue_layer(queue, LAYER_OUTLINE);
+    set_queue_color(queue, 90, 90, 90, 255);
+    queue_draw_rect(queue, &panel);
+
+    // Oldest frame on the left; a bar per frame, coloured by whether it
+    // made 60 Hz, 30 Hz or neither
+    int left = panel.x + HUD_PADDING;
+    int bottom = panel.y + panel.h - HUD_PADDING;
+    for (int i = 0; i < hud->frameCount; i++) {
+        float ms = hud->frameMs[(hud->next - hud->frameCount + i + PERF_HUD_FRAMES) % PERF_HUD_FRAMES];
+        int height = (int)(ms / HUD_GRAPH_MS * HUD_GRAPH_HEIGHT + 0.5f);
+        if (height > HUD_GRAPH_HEIGHT) height = HUD_GRAPH_HEIGHT;
+        if (height < 1) height = 1;
+
+        if (ms <= HUD_TARGET_MS) {
+            set_queue_color(queue, 0, 200, 0, 255);
+        } else if (ms <= 2 * HUD_TARGET_MS) {
+            set_queue_color(queue, 230, 200, 0, 255);
+        } else {
+            set_queue_color(queue, 230, 40, 40, 255);
+        }
+        SDL_Rect bar = {left + (PERF_HUD_FRAMES - hud->frameCount + i) * HUD_BAR_WIDTH, bottom - height,
+                        HUD_BAR_WIDTH, height};
+        queue_fill_rect(queue, &bar);
+    }
+
+    set_queue_layer(queue, LAYER_TEXT);
+    set_queue_color(queue, 160, 160, 160, 255);
+    int target = bottom - (int)(HUD_TARGET_MS / HUD_GRAPH_MS * HUD_GRAPH_HEIGHT + 0.5f);
+    queue_draw_line(queue, left, target, left + PERF_HUD_FRAMES * HUD_BAR_WIDTH - 1, target);
+
+    if (!font || hud->frameCount == 0) return;
+
+    float sorted[PERF_HUD_FRAMES];
+    memcpy(sorted, hud->frameMs, sizeof(float) * hud->frameCount);
+    qsort(sorted, hud->frameCount, sizeof(float), compare_floats);
+
+    char lines[HUD_TEXT_LINES][64];
+    snprintf(lines[0], sizeof(lines[0]), "%.1f fps  %.1f ticks/s", hud->fps, hud->tickRate);
+    snprintf(lines[1], sizeof(lines[1]), "p50 %.1f  p95 %.1f  p99 %.1f ms",
+             percentile(sorted, hud->frameCount, 50), percentile(sorted, hud->frameCount, 95),
+             percentile(sorted, hud->frameCount, 99));
+    snprintf(lines[2], sizeof(lines[2]), "%u draw calls  %u text textures",
+             queue->frameCalls, hud->textures);
+
+    SDL_Color white = {255, 255, 255, 255};
+    for (int i = 0; i < HUD_TEXT_LINES; i++) {
+        draw_text(queue, font, lines[i], left, panel.y + HUD_PADDING + i * lineHeight, white);
+    }
+}
+
+void draw_perf_hud(PerfHud *hud, RenderQueue *queue, Font *font, unsigned labelMisses) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+
+    if (hud->lastFrame != 0) {
+        hud->frameMs[hud->next] = (float)((now - hud->lastFrame) * 1000.0 / frequency);
+        hud->next = (hud->next + 1) % PERF_HUD_FRAMES;
+        if (hud->frameCount < PERF_HUD_FRAMES) hud->frameCount++;
+    } else {
+        hud->secondStart = now;
+    }
+    hud->lastFrame = now;
+
+    hud->secondFrames++;
+    if (now - hud->secondStart >= frequency) {
+        double seconds = (double)(now - hud->secondStart) / frequency;
+        hud->fps = (float)(hud->secondFrames / seconds);
+        hud->tickRate = (float)(hud->secondTicks / seconds);
+        hud->secondFrames = hud->secondTicks = 0;
+        hud->secondStart = now;
+    }
+
+    hud->textures = labelMisses - hud->labelMisses;
+    hud->labelMisses = labelMisses;
+
+    hud->shown = hud->visible;
+    if (hud->visible) draw_overlay(hud, queue, font);
+}
@@ -0,0 +1,63 @@
+#ifndef PERF_HUD_H
+#define PERF_HUD_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#include "render_queue.h"
+#include "text.h"
+
+// The performance overlay, toggled with F3 in every scene. It shows the
+// frames presented and simulation ticks run over the last second, the
+// 50th, 95th and 99th percentile frame time over the last PERF_HUD_FRAMES
+// frames with a graph of them, and the renderer calls and label textures
+// the frames took.
+//
+// A frame is measured from one call of draw_perf_hud() to the next, made
+// just before each present, so it covers everything the loop does between
+// presents: events, ticks, drawing, the overlay itself and the present and
+// wait before the next one. Scenes that only present when something
+// changed (challenge mode) show the rate they actually present at.
+//
+// While hidden the overlay only stores the frame time.
+
+#define PERF_HUD_FRAMES 120  // Frame times kept for the percentiles and graph
+
+typedef struct {
+    bool visible;
+    bool shown;  // Drawn into the last frame presented
+
+    float frameMs[PERF_HUD_FRAMES];  // A ring of the latest frame times
+    int frameCount;
+    int next;
+    Uint64 lastFrame;  // Performance counter at the last draw_perf_hud()
+
+    // Counted up during the current second, then turned into rates
+    Uint64 secondStart;
+    int secondFrames;
+    int secondTicks;
+    float fps;
+    float tickRate;
+
+    unsigned labelMisses;  // Total over the fonts at the last frame
+    unsigned textures;     // Label textures the last frame created
+} PerfHud;
+
+// Count a simulation tick; call it after every step_game()
+static inline void perf_hud_tick(PerfHud *hud) {
+    hud->secondTicks++;
+}
+
+// Whether the next frame has to be presented for the overlay to appear or
+// to go away, for scenes that skip frames where nothing changed
+static inline bool perf_hud_needs_frame(const PerfHud *hud) {
+    return hud->visible || hud->shown;
+}
+
+// Record the frame about to be presented and, while visible, queue the
+// overlay over it. `labelMisses` is the sum of Font.labelMisses over every
+// font in use; the overlay draws its own text from the atlas of `font`,
+// which may be NULL to leave the text out.
+void draw_perf_hud(PerfHud *hud, RenderQueue *queue, Font *font, unsigned labelMisses);
+
+#endif
@@ -0,0 +1,123 @@
+// Headless replay player: re-simulates recorded matches (see replay.h) with
+// rendering off and checks each one ends the way it did when recorded.
+//
+// Build: gcc -O2 -o playback playback.c replay.c snake_sim.c
+// Usage: playback [--realtime] [--repeat N] replay...
+//
+// By default matches run as fast as the CPU allows and the tick rate is
+// reported, which makes a folder of recordings a regression workload.
+// --realtime waits out each tick's updateDelay instead, so a match takes
+// as long as it did to play. Exits non-zero if any match plays out
+// differently from its recording.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "replay.h"
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void sleep_ms(int ms) {
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+#endif
+}
+
+// Play the recording through once. Returns false if it doesn't end the way
+// it was recorded.
+static bool play(Replay *replay, Game *game, bool realtime) {
+    GameInput input;
+
+    if (!start_replay(replay, game)) {
+        printf("Out of memory\n");
+        exit(1);
+    }
+    while (replay_input(replay, game, &input)) {
+        step_game(game, &input);
+        if (realtime) sleep_ms(game->updateDelay);
+    }
+    return replay_matches(replay, game);
+}
+
+int main(int argc, char *argv[]) {
+    bool realtime = false;
+    int repeat = 1;
+    int first = 1;
+
+    for (; first < argc && argv[first][0] == '-'; first++) {
+        if (strcmp(argv[first], "--realtime") == 0) {
+            realtime = true;
+        } else if (strcmp(argv[first], "--repeat") == 0 && first + 1 < argc) {
+            repeat = atoi(argv[++first]);
+        } else {
+            break;
+        }
+    }
+    if (first >= argc || repeat < 1) {
+        printf("Usage: %s [--realtime] [--repeat N] replay...\n", argv[0]);
+        return 1;
+    }
+
+    Game game = {0};
+    bool all_ok = true;
+    int played = 0;
+    long long total_ticks = 0;
+    double total_seconds = 0;
+
+    for (int i = first; i < argc; i++) {
+        Replay replay;
+        if (!load_replay(&replay, argv[i])) {
+            all_ok = false;
+            continue;
+        }
+
+        bool ok = true;
+        double start = now_seconds();
+        for (int r = 0; r < repeat && ok; r++) {
+            ok = play(&replay, &game, realtime);
+        }
+        double seconds = now_seconds() - start;
+
+        printf("%s: %u ticks, %zu turns, %zu bytes, score", argv[i], replay.ticks,
+               replay.eventCount, replay.size);
+        for (int s = 0; s < game.snakeCount; s++) {
+            printf(" %d", game.snakes[s].score);
+        }
+        if (ok) {
+            printf(", %.0f ticks/sec\n", (double)replay.ticks * repeat / seconds);
+        } else {
+            printf(" after %u ticks, MISMATCH (recorded", game.tick);
+            for (int s = 0; s < game.snakeCount; s++) {
+                printf(" %d", replay.score[s]);
+            }
+            printf(" after %u)\n", replay.ticks);
+        }
+
+        all_ok = all_ok && ok;
+        played++;
+        total_ticks += (long long)replay.ticks * repeat;
+        total_seconds += seconds;
+        free_replay(&replay);
+    }
+
+    if (played > 1 && total_seconds > 0) {
+        printf("%d replays, %lld ticks, %.0f ticks/sec\n",
+               played, total_ticks, total_ticks / total_seconds);
+    }
+
+    free_game(&game);
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,270 @@
+#include "render_queue.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_COMMANDS 256
+
+static const int QUAD_INDICES[6] = {0, 1, 2, 0, 2, 3};
+static const SDL_FRect FULL_SOURCE = {0, 0, 1, 1};
+static const SDL_Color WHITE = {255, 255, 255, 255};
+
+void init_render_queue(RenderQueue *queue, SDL_Renderer *renderer) {
+    memset(queue, 0, sizeof(RenderQueue));
+    queue->renderer = renderer;
+    queue->color = WHITE;
+}
+
+void free_render_queue(RenderQueue *queue) {
+    free(queue->commands);
+    free(queue->rects);
+    free(queue->vertices);
+    free(queue->indices);
+    queue->commands = NULL;
+    queue->rects = NULL;
+    queue->vertices = NULL;
+    queue->indices = NULL;
+    queue->count = queue->capacity = 0;
+    queue->rectCapacity = queue->quadCapacity = 0;
+}
+
+void set_queue_color(RenderQueue *queue, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+    queue->color = (SDL_Color){r, g, b, a};
+}
+
+void set_queue_layer(RenderQueue *queue, RenderLayer layer) {
+    queue->layer = layer;
+}
+
+// Append a command with the current layer, or NULL if out of memory
+static RenderCommand *push_command(RenderQueue *queue) {
+    if (queue->count == queue->capacity) {
+        int capacity = queue->capacity ? queue->capacity * 2 : INITIAL_COMMANDS;
+        RenderCommand *commands = realloc(queue->commands, sizeof(RenderCommand) * capacity);
+        if (!commands) return NULL;
+        queue->commands = commands;
+        queue->capacity = capacity;
+    }
+
+    RenderCommand *command = &queue->commands[queue->count];
+    command->layer = queue->layer;
+    command->order = queue->count++;
+    return command;
+}
+
+void queue_fill_rect(RenderQueue *queue, const SDL_Rect *rect) {
+    if (rect->w <= 0 || rect->h <= 0) return;
+
+    RenderCommand *command = push_command(queue);
+    if (!command) return;
+    command->texture = NULL;
+    command->rect = *rect;
+    command->color = queue->color;
+}
+
+// The four edges SDL_RenderDrawRect() would draw
+void queue_draw_rect(RenderQueue *queue, const SDL_Rect *rect) {
+    if (rect->w <= 0 || rect->h <= 0) return;
+
+    SDL_Rect edges[4] = {
+        {rect->x, rect->y, rect->w, 1},
+        {rect->x, rect->y + rect->h - 1, rect->w, 1},
+        {rect->x, rect->y, 1, rect->h},
+        {rect->x + rect->w - 1, rect->y, 1, rect->h}
+    };
+    for (int i = 0; i < 4; i++) {
+        queue_fill_rect(queue, &edges[i]);
+    }
+}
+
+void queue_draw_line(RenderQueue *queue, int x1, int y1, int x2, int y2) {
+    if (x1 == x2 || y1 == y2) {
+        SDL_Rect rect = {
+            x1 < x2 ? x1 : x2,
+            y1 < y2 ? y1 : y2,
+            abs(x2 - x1) + 1,
+            abs(y2 - y1) + 1
+        };
+        queue_fill_rect(queue, &rect);
+        return;
+    }
+
+    flush_render_queue(queue);
+    SDL_Color c = queue->color;
+    SDL_SetRenderDrawColor(queue->renderer, c.r, c.g, c.b, c.a);
+    SDL_RenderDrawLine(queue->renderer, x1, y1, x2, y2);
+    queue->calls += 2;
+}
+
+void queue_quad(RenderQueue *queue, SDL_Texture *texture, const SDL_Rect *rect, SDL_FRect source,
+                SDL_Color color) {
+    if (!texture || rect->w <= 0 || rect->h <= 0) return;
+
+    RenderCommand *command = push_command(queue);
+    if (!command) return;
+    command->texture = texture;
+    command->rect = *rect;
+    command->source = source;
+    command->color = color;
+}
+
+void queue_copy(RenderQueue *queue, SDL_Texture *texture, const SDL_Rect *source, const SDL_Rect *rect) {
+    SDL_FRect uv = FULL_SOURCE;
+
+    if (source) {
+        int width, height;
+        if (!texture || SDL_QueryTexture(texture, NULL, NULL, &width, &height) != 0) return;
+        uv = (SDL_FRect){(float)source->x / width, (float)source->y / height,
+                         (float)source->w / width, (float)source->h / height};
+    }
+    queue_quad(queue, texture, rect, uv, WHITE);
+}
+
+void queue_clear(RenderQueue *queue) {
+    flush_render_queue(queue);
+    SDL_Color c = queue->color;
+    SDL_SetRenderDrawColor(queue->renderer, c.r, c.g, c.b, c.a);
+    SDL_RenderClear(queue->renderer);
+    queue->calls += 2;
+}
+
+void set_queue_clip(RenderQueue *queue, const SDL_Rect *clip) {
+    flush_render_queue(queue);
+    SDL_RenderSetClipRect(queue->renderer, clip);
+    queue->calls++;
+}
+
+void set_queue_target(RenderQueue *queue, SDL_Texture *target) {
+    flush_render_queue(queue);
+    SDL_SetRenderTarget(queue->renderer, target);
+    queue->calls++;
+}
+
+// --- Flushing ---
+
+static Uint32 pack_color(SDL_Color c) {
+    return (Uint32)c.r << 24 | (Uint32)c.g << 16 | (Uint32)c.b << 8 | c.a;
+}
+
+// Layer, then texture (solid rectangles first), then colour for solid
+// rectangles, then submission order
+static int compare_commands(const void *a, const void *b) {
+    const RenderCommand *x = a, *y = b;
+
+    if (x->layer != y->layer) return x->layer < y->layer ? -1 : 1;
+
+    uintptr_t tx = (uintptr_t)x->texture, ty = (uintptr_t)y->texture;
+    if (tx != ty) return tx < ty ? -1 : 1;
+
+    if (!x->texture) {
+        Uint32 cx = pack_color(x->color), cy = pack_color(y->color);
+        if (cx != cy) return cx < cy ? -1 : 1;
+    }
+    return x->order < y->order ? -1 : x->order > y->order;
+}
+
+static bool same_batch(const RenderCommand *a, const RenderCommand *b) {
+    if (a->texture != b->texture) return false;
+    return a->texture || pack_color(a->color) == pack_color(b->color);
+}
+
+// Room for `quads` quads, with the index pattern filled in once
+static bool reserve_quads(RenderQueue *queue, int quads) {
+    if (quads <= queue->quadCapacity) return true;
+
+    int capacity = queue->quadCapacity ? queue->quadCapacity : 64;
+    while (capacity < quads) capacity *= 2;
+
+    SDL_Vertex *vertices = realloc(queue->vertices, sizeof(SDL_Vertex) * 4 * capacity);
+    if (!vertices) return false;
+    queue->vertices = vertices;
+
+    int *indices = realloc(queue->indices, sizeof(int) * 6 * capacity);
+    if (!indices) return false;
+    queue->indices = indices;
+
+    for (int i = queue->quadCapacity; i < capacity; i++) {
+        for (int k = 0; k < 6; k++) {
+            indices[i * 6 + k] = i * 4 + QUAD_INDICES[k];
+        }
+    }
+    queue->quadCapacity = capacity;
+    return true;
+}
+
+static bool reserve_rects(RenderQueue *queue, int rects) {
+    if (rects <= queue->rectCapacity) return true;
+
+    int capacity = queue->rectCapacity ? queue->rectCapacity : 64;
+    while (capacity < rects) capacity *= 2;
+
+    SDL_Rect *buffer = realloc(queue->rects, sizeof(SDL_Rect) * capacity);
+    if (!buffer) return false;
+    queue->rects = buffer;
+    queue->rectCapacity = capacity;
+    return true;
+}
+
+static void submit_rects(RenderQueue *queue, const RenderCommand *run, int count) {
+    if (!reserve_rects(queue, count)) return;
+
+    for (int i = 0; i < count; i++) {
+        queue->rects[i] = run[i].rect;
+    }
+    SDL_Color c = run->color;
+    SDL_SetRenderDrawColor(queue->renderer, c.r, c.g, c.b, c.a);
+    SDL_RenderFillRects(queue->renderer, queue->rects, count);
+    queue->calls += 2;
+}
+
+static void submit_quads(RenderQueue *queue, const RenderCommand *run, int count) {
+    if (!reserve_quads(queue, count)) return;
+
+    for (int i = 0; i < count; i++) {
+        const SDL_Rect *r = &run[i].rect;
+        const SDL_FRect *s = &run[i].source;
+        float left = (float)r->x, top = (float)r->y;
+        float right = left + r->w, bottom = top + r->h;
+        float u0 = s->x, v0 = s->y, u1 = s->x + s->w, v1 = s->y + s->h;
+        SDL_Color color = run[i].color;
+
+        SDL_Vertex *v = &queue->vertices[i * 4];
+        v[0] = (SDL_Vertex){{left, top}, color, {u0, v0}};
+        v[1] = (SDL_Vertex){{right, top}, color, {u1, v0}};
+        v[2] = (SDL_Vertex){{right, bottom}, color, {u1, v1}};
+        v[3] = (SDL_Vertex){{left, bottom}, color, {u0, v1}};
+    }
+    SDL_RenderGeometry(queue->renderer, run->texture, queue->vertices, count * 4,
+                       queue->indices, count * 6);
+    queue->calls++;
+}
+
+void flush_render_queue(RenderQueue *queue) {
+    if (queue->count == 0) return;
+
+    qsort(queue->commands, queue->count, sizeof(RenderCommand), compare_commands);
+
+    int start = 0;
+    while (start < queue->count) {
+        const RenderCommand *run = &queue->commands[start];
+        int end = start + 1;
+        while (end < queue->count && same_batch(run, &queue->commands[end])) end++;
+
+        if (run->texture) {
+            submit_quads(queue, run, end - start);
+        } else {
+            submit_rects(queue, run, end - start);
+        }
+        start = end;
+    }
+    queue->count = 0;
+}
+
+void present_render_queue(RenderQueue *queue) {
+    flush_render_queue(queue);
+    SDL_RenderPresent(queue->renderer);
+    queue->calls++;
+    queue->frameCalls = queue->calls;
+    queue->calls = 0;
+}
@@ -0,0 +1,96 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+// Per-frame draw command queue shared by the front-ends. Draw code records
+// rectangles, lines and textured quads with the same colour-then-draw
+// pattern as the SDL calls they replace; nothing reaches the renderer until
+// the queue is flushed. A flush sorts the commands by layer, then texture,
+// then colour, and submits each run of solid rectangles with one
+// SDL_RenderFillRects() and each run of one texture with one
+// SDL_RenderGeometry(), so a whole frame takes a handful of renderer calls.
+//
+// Within a layer the sort is free to reorder commands of different colours
+// or textures, so draws that overlap and must stay in order either go on
+// different layers or have a flush between them. Commands of the same
+// colour or texture keep their submission order.
+
+typedef enum {
+    LAYER_BACKGROUND,  // Overlays and cleared board cells
+    LAYER_GRID,
+    LAYER_BORDER,      // Board border, over the grid lines
+    LAYER_ITEMS,       // Fruit and obstacles
+    LAYER_SNAKE,
+    LAYER_PANEL,       // UI bar and button faces
+    LAYER_OUTLINE,     // Button and checkbox borders, UI bar separator
+    LAYER_TEXT,
+    LAYER_COUNT
+} RenderLayer;
+
+typedef struct {
+    SDL_Texture *texture;  // NULL for a filled rectangle
+    SDL_Rect rect;
+    SDL_FRect source;      // Texture coordinates, 0..1
+    SDL_Color color;       // Fill colour, or vertex colour for textures
+    int layer;
+    int order;             // Submission order, to keep the sort stable
+} RenderCommand;
+
+typedef struct {
+    SDL_Renderer *renderer;
+
+    RenderCommand *commands;
+    int count;
+    int capacity;
+
+    // State for the next command, as SDL_SetRenderDrawColor() would be
+    SDL_Color color;
+    RenderLayer layer;
+
+    // Scratch buffers for a flush
+    SDL_Rect *rects;
+    int rectCapacity;
+    SDL_Vertex *vertices;
+    int *indices;
+    int quadCapacity;
+
+    // Renderer calls issued since the last present, and in the last frame
+    unsigned calls;
+    unsigned frameCalls;
+} RenderQueue;
+
+void init_render_queue(RenderQueue *queue, SDL_Renderer *renderer);
+void free_render_queue(RenderQueue *queue);
+
+// Colour and layer for the commands that follow
+void set_queue_color(RenderQueue *queue, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+void set_queue_layer(RenderQueue *queue, RenderLayer layer);
+
+// Solid shapes in the current colour. Lines must be horizontal or vertical
+// to be batched; others are flushed and drawn on the spot. Both end points
+// are included, as with SDL_RenderDrawLine().
+void queue_fill_rect(RenderQueue *queue, const SDL_Rect *rect);
+void queue_draw_rect(RenderQueue *queue, const SDL_Rect *rect);
+void queue_draw_line(RenderQueue *queue, int x1, int y1, int x2, int y2);
+
+// `source` (NULL for all) of `texture` stretched over `rect`, as
+// SDL_RenderCopy() would draw it
+void queue_copy(RenderQueue *queue, SDL_Texture *texture, const SDL_Rect *source, const SDL_Rect *rect);
+
+// A textured quad with explicit texture coordinates and vertex colour, for
+// atlases and tinted sprites
+void queue_quad(RenderQueue *queue, SDL_Texture *texture, const SDL_Rect *rect, SDL_FRect source,
+                SDL_Color color);
+
+// These act on the renderer at once, so whatever is queued is drawn first
+void queue_clear(RenderQueue *queue);
+void set_queue_clip(RenderQueue *queue, const SDL_Rect *clip);
+void set_queue_target(RenderQueue *queue, SDL_Texture *target);
+void flush_render_queue(RenderQueue *queue);
+
+// Flush, present and start counting the next frame's renderer calls
+void present_render_queue(RenderQueue *queue);
+
+#endif
@@ -0,0 +1,281 @@
+#include "replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_VARINT_BYTES 10
+
+static const char REPLAY_MAGIC[4] = {'S', 'N', 'K', 'R'};
+
+// --- Varints ---
+
+static int put_varint(unsigned char *out, uint64_t value) {
+    int length = 0;
+    while (value >= 0x80) {
+        out[length++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (unsigned char)value;
+    return length;
+}
+
+static bool get_varint(const unsigned char *data, size_t size, size_t *cursor, uint64_t *value) {
+    *value = 0;
+    for (int i = 0; i < MAX_VARINT_BYTES && *cursor < size; i++) {
+        unsigned char byte = data[(*cursor)++];
+        *value |= (uint64_t)(byte & 0x7f) << (7 * i);
+        if (!(byte & 0x80)) return true;
+    }
+    return false; // Truncated or too long
+}
+
+static unsigned pack_features(const GameFeatures *features) {
+    return (features->movingFruit ? 1u : 0) | (features->multiFruit ? 2u : 0) |
+           (features->timed ? 4u : 0) | (features->obstacles ? 8u : 0) |
+           (features->speed ? 16u : 0) | (features->chaos ? 32u : 0);
+}
+
+static GameFeatures unpack_features(unsigned bits) {
+    GameFeatures features = {0};
+    features.movingFruit = bits & 1;
+    features.multiFruit = bits & 2;
+    features.timed = bits & 4;
+    features.obstacles = bits & 8;
+    features.speed = bits & 16;
+    features.chaos = bits & 32;
+    return features;
+}
+
+static int mode_snakes(GameMode mode) {
+    return mode == MODE_MULTI ? 2 : 1;
+}
+
+// --- Recording ---
+
+static void append_varint(ReplayRecorder *recorder, uint64_t value) {
+    if (recorder->failed) return;
+
+    if (recorder->size + MAX_VARINT_BYTES > recorder->capacity) {
+        size_t capacity = recorder->capacity ? recorder->capacity * 2 : 256;
+        unsigned char *grown = realloc(recorder->data, capacity);
+        if (!grown) {
+            recorder->failed = true;
+            return;
+        }
+        recorder->data = grown;
+        recorder->capacity = capacity;
+    }
+
+    recorder->size += put_varint(recorder->data + recorder->size, value);
+}
+
+void record_input(ReplayRecorder *recorder, const Game *game, const GameInput *input) {
+    if (game->tick == 0) {
+        // First tick of a new match
+        recorder->size = 0;
+        recorder->eventCount = 0;
+        recorder->lastTick = 0;
+        recorder->failed = false;
+        for (int i = 0; i < MAX_SNAKES; i++) {
+            recorder->last[i] = DIR_NONE;
+        }
+    }
+    if (!input) return;
+
+    for (int i = 0; i < game->snakeCount; i++) {
+        Direction dir = input->dir[i];
+
+        // Turning the way the snake last turned changes nothing
+        if (dir == DIR_NONE || dir == recorder->last[i]) continue;
+
+        uint64_t delta = game->tick - recorder->lastTick;
+        append_varint(recorder, (delta << 3) | ((uint64_t)i << 2) | (uint64_t)(dir - DIR_UP));
+        recorder->eventCount++;
+        recorder->last[i] = dir;
+        recorder->lastTick = game->tick;
+    }
+}
+
+bool save_replay(const ReplayRecorder *recorder, const Game *game, const char *path) {
+    if (recorder->failed) {
+        printf("%s: recording incomplete (out of memory), not saved\n", path);
+        return false;
+    }
+
+    unsigned char header[sizeof(REPLAY_MAGIC) + 8 * MAX_VARINT_BYTES];
+    size_t header_size = sizeof(REPLAY_MAGIC);
+    memcpy(header, REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    header_size += put_varint(header + header_size, REPLAY_VERSION);
+    header_size += put_varint(header + header_size, game->width);
+    header_size += put_varint(header + header_size, game->height);
+    header_size += put_varint(header + header_size, game->mode);
+    header_size += put_varint(header + header_size, pack_features(&game->features));
+    header_size += put_varint(header + header_size, game->matchRng.state);
+    header_size += put_varint(header + header_size, game->matchRng.inc);
+    header_size += put_varint(header + header_size, recorder->eventCount);
+
+    unsigned char trailer[(1 + MAX_SNAKES) * MAX_VARINT_BYTES];
+    size_t trailer_size = put_varint(trailer, game->tick);
+    for (int i = 0; i < game->snakeCount; i++) {
+        trailer_size += put_varint(trailer + trailer_size, (uint64_t)game->snakes[i].score);
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        printf("%s: cannot write\n", path);
+        return false;
+    }
+
+    bool ok = fwrite(header, 1, header_size, file) == header_size &&
+              fwrite(recorder->data, 1, recorder->size, file) == recorder->size &&
+              fwrite(trailer, 1, trailer_size, file) == trailer_size;
+    ok = fclose(file) == 0 && ok;
+    if (!ok) printf("%s: write failed\n", path);
+    return ok;
+}
+
+void free_recorder(ReplayRecorder *recorder) {
+    free(recorder->data);
+    memset(recorder, 0, sizeof(ReplayRecorder));
+}
+
+// --- Playback ---
+
+static bool read_file(const char *path, unsigned char **data, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return false;
+
+    bool ok = fseek(file, 0, SEEK_END) == 0;
+    long length = ok ? ftell(file) : -1;
+    ok = length >= 0 && fseek(file, 0, SEEK_SET) == 0;
+
+    *data = ok ? malloc(length > 0 ? (size_t)length : 1) : NULL;
+    ok = *data && fread(*data, 1, (size_t)length, file) == (size_t)length;
+    fclose(file);
+
+    if (!ok) {
+        free(*data);
+        *data = NULL;
+        return false;
+    }
+    *size = (size_t)length;
+    return true;
+}
+
+// Decode the next event into nextTick/nextSnake/nextDir
+static bool next_event(Replay *replay) {
+    uint64_t value;
+    replay->hasNext = replay->eventsLeft > 0 &&
+                      get_varint(replay->data, replay->size, &replay->cursor, &value);
+    if (!replay->hasNext) return false;
+
+    replay->eventsLeft--;
+    replay->nextTick += (unsigned)(value >> 3);
+    replay->nextSnake = (int)((value >> 2) & 1);
+    replay->nextDir = (Direction)(DIR_UP + (value & 3));
+    return true;
+}
+
+bool load_replay(Replay *replay, const char *path) {
+    memset(replay, 0, sizeof(Replay));
+
+    if (!read_file(path, &replay->data, &replay->size)) {
+        printf("%s: cannot read\n", path);
+        return false;
+    }
+
+    const unsigned char *data = replay->data;
+    size_t size = replay->size;
+    size_t cursor = sizeof(REPLAY_MAGIC);
+    uint64_t version, width, height, mode, features, state, inc, events;
+
+    bool ok = size >= sizeof(REPLAY_MAGIC) && memcmp(data, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) == 0 &&
+              get_varint(data, size, &cursor, &version) && version == REPLAY_VERSION &&
+              get_varint(data, size, &cursor, &width) &&
+              get_varint(data, size, &cursor, &height) &&
+              get_varint(data, size, &cursor, &mode) &&
+              get_varint(data, size, &cursor, &features) &&
+              get_varint(data, size, &cursor, &state) &&
+              get_varint(data, size, &cursor, &inc) &&
+              get_varint(data, size, &cursor, &events) &&
+              width >= MIN_GRID_WIDTH && width <= MAX_GRID_SIZE &&
+              height >= MIN_GRID_HEIGHT && height <= MAX_GRID_SIZE &&
+              mode <= MODE_MULTI && features < 64 && (inc & 1);
+
+    if (ok) {
+        replay->width = (int)width;
+        replay->height = (int)height;
+        replay->mode = (GameMode)mode;
+        replay->features = unpack_features((unsigned)features);
+        replay->rng.state = state;
+        replay->rng.inc = inc;
+        replay->eventCount = (size_t)events;
+        replay->eventsStart = cursor;
+
+        // Walk the events once so playback can trust them
+        replay->cursor = cursor;
+        replay->eventsLeft = replay->eventCount;
+        for (size_t i = 0; ok && i < replay->eventCount; i++) {
+            ok = next_event(replay) && replay->nextSnake < mode_snakes(replay->mode);
+        }
+        cursor = replay->cursor;
+    }
+
+    uint64_t ticks = 0, score;
+    ok = ok && get_varint(data, size, &cursor, &ticks) && ticks <= UINT32_MAX &&
+         (replay->eventCount == 0 || replay->nextTick < ticks);
+    replay->ticks = (unsigned)ticks;
+    for (int i = 0; ok && i < mode_snakes(replay->mode); i++) {
+        ok = get_varint(data, size, &cursor, &score) && score <= INT32_MAX;
+        replay->score[i] = (int)score;
+    }
+    ok = ok && cursor == size;
+
+    if (!ok) {
+        printf("%s: not a version %d replay, or damaged\n", path, REPLAY_VERSION);
+        free_replay(replay);
+        return false;
+    }
+    return true;
+}
+
+void free_replay(Replay *replay) {
+    free(replay->data);
+    memset(replay, 0, sizeof(Replay));
+}
+
+bool start_replay(Replay *replay, Game *game) {
+    if (!configure_game(game, replay->mode, &replay->features, replay->width, replay->height)) {
+        return false;
+    }
+    game->rng = replay->rng;
+    reset_game(game);
+
+    replay->cursor = replay->eventsStart;
+    replay->eventsLeft = replay->eventCount;
+    replay->nextTick = 0;
+    next_event(replay);
+    return true;
+}
+
+bool replay_input(Replay *replay, const Game *game, GameInput *input) {
+    for (int i = 0; i < MAX_SNAKES; i++) {
+        input->dir[i] = DIR_NONE;
+    }
+    if (game->over || game->tick >= replay->ticks) return false;
+
+    while (replay->hasNext && replay->nextTick == game->tick) {
+        input->dir[replay->nextSnake] = replay->nextDir;
+        next_event(replay);
+    }
+    return true;
+}
+
+bool replay_matches(const Replay *replay, const Game *game) {
+    if (game->tick != replay->ticks) return false;
+    for (int i = 0; i < game->snakeCount; i++) {
+        if (game->snakes[i].score != replay->score[i]) return false;
+    }
+    return true;
+}
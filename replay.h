@@ -0,0 +1,84 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "snake_sim.h"
+
+// Match recordings: enough to re-simulate a match tick for tick, since the
+// simulation only depends on its settings, the generator state it started
+// from and the inputs.
+//
+// File layout, every number an unsigned LEB128 varint:
+//     "SNKR" version
+//     width height mode features   (features: one bit per GameFeatures flag)
+//     rng.state rng.inc            (Game.matchRng)
+//     event count, then per event  (tick delta << 3) | (snake << 2) | (dir - DIR_UP)
+//     ticks, then score per snake  (how the match ended, for checking)
+// Only turns are stored, and only when they differ from the snake's last
+// one, so a minute of play usually takes a few hundred bytes.
+
+#define REPLAY_VERSION 1
+
+// Collects the turns of the match being played
+typedef struct {
+    unsigned char *data; // Encoded events
+    size_t size, capacity;
+    size_t eventCount;
+    unsigned lastTick;
+    Direction last[MAX_SNAKES];
+    bool failed;         // Out of memory, the recording is incomplete
+} ReplayRecorder;
+
+// Call before every step_game() with the input about to be applied. A new
+// recording starts whenever the game is on its first tick.
+void record_input(ReplayRecorder *recorder, const Game *game, const GameInput *input);
+
+// Write the recording of the match that just ended. Prints a message and
+// returns false if the file can't be written.
+bool save_replay(const ReplayRecorder *recorder, const Game *game, const char *path);
+
+void free_recorder(ReplayRecorder *recorder);
+
+// A loaded recording being played back
+typedef struct {
+    int width, height;
+    GameMode mode;
+    GameFeatures features;
+    Rng rng;
+    unsigned ticks;            // Recorded match length
+    int score[MAX_SNAKES];     // Recorded final scores
+
+    unsigned char *data;       // The whole file
+    size_t size;
+    size_t eventCount;
+    size_t eventsStart;        // Offset of the first event
+
+    // Playback position
+    size_t cursor;
+    size_t eventsLeft;         // Events after the next one
+    bool hasNext;              // next* hold an event not yet played
+    unsigned nextTick;
+    int nextSnake;
+    Direction nextDir;
+} Replay;
+
+// Read and check a recording. Prints a message and returns false if the
+// file is missing, malformed or from another version.
+bool load_replay(Replay *replay, const char *path);
+void free_replay(Replay *replay);
+
+// Configure and reset `game` as the recorded match started (the Game must
+// be zeroed or previously configured) and rewind to the first event.
+// Returns false if the game can't be configured.
+bool start_replay(Replay *replay, Game *game);
+
+// Fill in the input for the tick `game` is about to play. Returns false
+// once the recorded match is over.
+bool replay_input(Replay *replay, const Game *game, GameInput *input);
+
+// Whether the game ended the way the recording did
+bool replay_matches(const Replay *replay, const Game *game);
+
+#endif
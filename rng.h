@@ -0,0 +1,52 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// PCG32 (XSH-RR variant, see pcg-random.org): 64 bits of state, 32-bit
+// output, small and fast enough to give every game its own generator.
+// The same seed and stream always produce the same sequence on every
+// platform.
+typedef struct {
+    uint64_t state;
+    uint64_t inc; // Stream selector, always odd
+} Rng;
+
+static inline uint32_t rng_next(Rng *rng) {
+    uint64_t old = rng->state;
+    rng->state = old * 6364136223846793005ULL + rng->inc;
+
+    uint32_t shifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rotate = (uint32_t)(old >> 59);
+    return (shifted >> rotate) | (shifted << ((-rotate) & 31));
+}
+
+// Generators with different streams give unrelated sequences even from the
+// same seed
+static inline void rng_seed(Rng *rng, uint64_t seed, uint64_t stream) {
+    rng->state = 0;
+    rng->inc = (stream << 1) | 1;
+    rng_next(rng);
+    rng->state += seed;
+    rng_next(rng);
+}
+
+// Uniform in [0, bound), bound > 0. Lemire's multiply-and-reject: the high
+// half of a 32x32 product, drawing again in the rare case the low half
+// falls in the biased range, so there is no modulo bias and usually no
+// division.
+static inline uint32_t rng_below(Rng *rng, uint32_t bound) {
+    uint64_t product = (uint64_t)rng_next(rng) * bound;
+    uint32_t low = (uint32_t)product;
+
+    if (low < bound) {
+        uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            product = (uint64_t)rng_next(rng) * bound;
+            low = (uint32_t)product;
+        }
+    }
+    return (uint32_t)(product >> 32);
+}
+
+#endif
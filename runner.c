@@ -0,0 +1,556 @@
+// Headless match runner: plays a list of matches on every core and writes
+// the results to one file.
+//
+// Build: gcc -O2 -pthread -o runner runner.c agents.c replay.c snake_sim.c options.c
+// Usage: runner [--board WIDTHxHEIGHT] [--threads N] [--max-ticks N] [--scale]
+//               [--record PREFIX] jobs.txt [results.csv]
+//
+// Job file, one match per line, '#' starts a comment:
+//     <mode> <features> <seed> <agent> [repeat]
+// mode is single, challenge or multi; features is classic, chaos or a
+// comma-separated list of moving, multi, timed, obstacles and speed (only
+// challenge mode uses them); agent is one of the agents in agents.c and
+// plays every snake. With a repeat count the line expands into that many
+// matches on seeds seed, seed + 1, ... The whole file may expand into at
+// most MAX_JOBS matches.
+//
+// Matches are dealt round-robin to one deque per thread. A thread works
+// through its own deque from the back and, once it runs dry, steals from
+// the front of another thread's, so uneven match lengths don't leave cores
+// idle. Every match depends only on its seed, so the results (written in
+// job order) are the same whatever the thread count.
+//
+// --scale runs the whole list with 1, 2, 4, ... threads up to --threads,
+// reports the speedup over one thread and checks the results agree.
+//
+// --record saves every match as a replay named PREFIX<job>.rpl, e.g.
+// --record replays/match gives replays/match0.rpl, replays/match1.rpl, ...
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "agents.h"
+#include "options.h"
+#include "replay.h"
+#include "snake_sim.h"
+
+#define DEFAULT_OUTPUT "results.csv"
+#define MAX_THREADS 256
+#define MAX_JOBS 10000000  // Matches one job file may expand into
+
+typedef struct {
+    GameMode mode;
+    GameFeatures features;
+    uint64_t seed;
+    const Agent *agent;
+    int line; // Line in the job file, for messages
+} Job;
+
+typedef struct {
+    unsigned ticks;
+    int score[MAX_SNAKES];
+    bool finished; // Game over before the tick cap
+    int thread;
+} JobResult;
+
+// Job indices owned by one thread. The owner takes from the back, thieves
+// from the front; one lock per deque is plenty for matches that take
+// milliseconds each.
+typedef struct {
+    pthread_mutex_t lock;
+    int *jobs;
+    int front, back; // jobs[front..back) are still to run
+} Deque;
+
+typedef struct {
+    int index;
+    pthread_t thread;
+    Deque deque;
+    Rng rng; // Picks steal victims
+
+    // Stats
+    double busy; // Seconds spent playing matches
+    long matches;
+    long steals;
+    long long ticks;
+} Worker;
+
+typedef struct {
+    const Job *jobs;
+    JobResult *results;
+    int jobCount;
+    Worker *workers;
+    int workerCount;
+    unsigned maxTicks;
+    int width, height;
+    const char *recordPrefix; // NULL when not recording
+} Run;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int core_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+// --- Job file ---
+
+static const char *mode_name(GameMode mode) {
+    switch (mode) {
+        case MODE_SINGLE: return "single";
+        case MODE_CHALLENGE: return "challenge";
+        case MODE_MULTI: return "multi";
+    }
+    return "?";
+}
+
+static bool parse_mode(const char *text, GameMode *mode) {
+    if (strcmp(text, "single") == 0) *mode = MODE_SINGLE;
+    else if (strcmp(text, "challenge") == 0) *mode = MODE_CHALLENGE;
+    else if (strcmp(text, "multi") == 0) *mode = MODE_MULTI;
+    else return false;
+    return true;
+}
+
+static bool parse_features(const char *text, GameFeatures *features) {
+    memset(features, 0, sizeof(GameFeatures));
+
+    if (strcmp(text, "classic") == 0) return true;
+    if (strcmp(text, "chaos") == 0) {
+        GameFeatures chaos = {true, true, true, true, true, true};
+        *features = chaos;
+        return true;
+    }
+
+    char list[128];
+    if (strlen(text) >= sizeof(list)) return false;
+    strcpy(list, text);
+
+    for (char *name = strtok(list, ","); name; name = strtok(NULL, ",")) {
+        if (strcmp(name, "moving") == 0) features->movingFruit = true;
+        else if (strcmp(name, "multi") == 0) features->multiFruit = true;
+        else if (strcmp(name, "timed") == 0) features->timed = true;
+        else if (strcmp(name, "obstacles") == 0) features->obstacles = true;
+        else if (strcmp(name, "speed") == 0) features->speed = true;
+        else return false;
+    }
+    return true;
+}
+
+// Feature flags as they appear in the job file
+static void format_features(const GameFeatures *features, char *text, size_t size) {
+    if (features->chaos) {
+        snprintf(text, size, "chaos");
+        return;
+    }
+
+    text[0] = '\0';
+    const char *names[] = {"moving", "multi", "timed", "obstacles", "speed"};
+    const bool flags[] = {features->movingFruit, features->multiFruit, features->timed,
+                          features->obstacles, features->speed};
+    for (int i = 0; i < 5; i++) {
+        if (!flags[i]) continue;
+        if (text[0] != '\0') strncat(text, ",", size - strlen(text) - 1);
+        strncat(text, names[i], size - strlen(text) - 1);
+    }
+    if (text[0] == '\0') snprintf(text, size, "classic");
+}
+
+// Read the job file into a malloc'd array. Prints a message and returns
+// NULL on a bad line.
+static Job *load_jobs(const char *path, int *count) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        printf("%s: cannot open\n", path);
+        return NULL;
+    }
+
+    Job *jobs = NULL;
+    size_t capacity = 0;
+    *count = 0;
+
+    char line[256];
+    int line_number = 0;
+    bool ok = true;
+
+    while (ok && fgets(line, sizeof(line), file)) {
+        line_number++;
+
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        char mode_text[32], features_text[128], agent_text[32];
+        unsigned long long seed;
+        int repeat = 1;
+        char extra;
+
+        int fields = sscanf(line, "%31s %127s %llu %31s %d %c",
+                            mode_text, features_text, &seed, agent_text, &repeat, &extra);
+        if (fields <= 0) continue; // Blank or comment
+
+        Job job = {0};
+        job.line = line_number;
+        job.seed = seed;
+        job.agent = fields >= 4 ? find_agent(agent_text) : NULL;
+
+        if (fields < 4 || fields > 5 || repeat < 1 ||
+            !parse_mode(mode_text, &job.mode) || !parse_features(features_text, &job.features) ||
+            !job.agent) {
+            printf("%s:%d: expected <single|challenge|multi> <classic|chaos|feature,...> "
+                   "<seed> <%s> [repeat]\n", path, line_number, agent_names());
+            ok = false;
+            break;
+        }
+
+        if (repeat > MAX_JOBS - *count) {
+            printf("%s:%d: more than %d matches in the job file\n", path, line_number, MAX_JOBS);
+            ok = false;
+            break;
+        }
+
+        if ((size_t)(*count + repeat) > capacity) {
+            capacity = (size_t)(*count + repeat) * 2;
+            Job *grown = realloc(jobs, sizeof(Job) * capacity);
+            if (!grown) {
+                printf("Out of memory\n");
+                ok = false;
+                break;
+            }
+            jobs = grown;
+        }
+
+        for (int i = 0; i < repeat; i++) {
+            jobs[*count] = job;
+            jobs[*count].seed = job.seed + i;
+            (*count)++;
+        }
+    }
+
+    fclose(file);
+    if (ok && *count == 0) {
+        printf("%s: no jobs\n", path);
+        ok = false;
+    }
+    if (!ok) {
+        free(jobs);
+        return NULL;
+    }
+    return jobs;
+}
+
+// --- Matches ---
+
+static void play_match(const Run *run, int index, Game *game, ReplayRecorder *recorder) {
+    const Job *job = &run->jobs[index];
+    JobResult *result = &run->results[index];
+
+    if (!configure_game(game, job->mode, &job->features, run->width, run->height)) {
+        printf("Out of memory\n");
+        exit(1);
+    }
+    seed_game(game, job->seed);
+    reset_game(game);
+
+    // The agents get their own stream so they don't shift fruit placement
+    Rng agent_rng;
+    rng_seed(&agent_rng, job->seed, 1);
+    GameInput input = {{DIR_NONE, DIR_NONE}};
+
+    while (!game->over && game->tick < run->maxTicks) {
+        for (int i = 0; i < game->snakeCount; i++) {
+            input.dir[i] = game->snakes[i].alive
+                ? job->agent->choose(game, i, &agent_rng)
+                : DIR_NONE;
+        }
+        if (run->recordPrefix) record_input(recorder, game, &input);
+        step_game(game, &input);
+    }
+
+    if (run->recordPrefix) {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s%d.rpl", run->recordPrefix, index);
+        save_replay(recorder, game, path);
+    }
+
+    result->ticks = game->tick;
+    for (int i = 0; i < MAX_SNAKES; i++) {
+        result->score[i] = i < game->snakeCount ? game->snakes[i].score : 0;
+    }
+    result->finished = game->over;
+}
+
+// --- Work stealing ---
+
+static bool pop_back(Deque *deque, int *job) {
+    pthread_mutex_lock(&deque->lock);
+    bool found = deque->front < deque->back;
+    if (found) *job = deque->jobs[--deque->back];
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static bool steal_front(Deque *deque, int *job) {
+    pthread_mutex_lock(&deque->lock);
+    bool found = deque->front < deque->back;
+    if (found) *job = deque->jobs[deque->front++];
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+// Try every other worker once, starting from a random one. No new jobs
+// appear once the run starts, so coming back empty means we're done.
+static bool steal(const Run *run, Worker *self, int *job) {
+    int first = (int)rng_below(&self->rng, (uint32_t)run->workerCount);
+
+    for (int i = 0; i < run->workerCount; i++) {
+        Worker *victim = &run->workers[(first + i) % run->workerCount];
+        if (victim != self && steal_front(&victim->deque, job)) {
+            self->steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+typedef struct {
+    const Run *run;
+    Worker *worker;
+} WorkerArgs;
+
+static void *worker_main(void *arg) {
+    WorkerArgs *args = arg;
+    const Run *run = args->run;
+    Worker *self = args->worker;
+    Game game = {0};
+    ReplayRecorder recorder = {0};
+    int job;
+
+    while (pop_back(&self->deque, &job) || steal(run, self, &job)) {
+        double start = now_seconds();
+        play_match(run, job, &game, &recorder);
+        self->busy += now_seconds() - start;
+
+        run->results[job].thread = self->index;
+        self->matches++;
+        self->ticks += run->results[job].ticks;
+    }
+
+    free_game(&game);
+    free_recorder(&recorder);
+    return NULL;
+}
+
+// Play every job on `threads` threads. Returns the wall time, or a negative
+// value if the threads could not be started.
+static double run_jobs(Run *run, int threads) {
+    Worker workers[MAX_THREADS];
+    WorkerArgs args[MAX_THREADS];
+    int per_worker = (run->jobCount + threads - 1) / threads;
+
+    run->workers = workers;
+    run->workerCount = threads;
+
+    for (int i = 0; i < threads; i++) {
+        memset(&workers[i], 0, sizeof(Worker));
+        workers[i].index = i;
+        rng_seed(&workers[i].rng, 0, (uint64_t)i);
+        workers[i].deque.jobs = malloc(sizeof(int) * per_worker);
+        if (!workers[i].deque.jobs) {
+            printf("Out of memory\n");
+            exit(1);
+        }
+        pthread_mutex_init(&workers[i].deque.lock, NULL);
+    }
+
+    // Deal round-robin so every thread starts with a mix of the job list;
+    // each deque is reversed so its owner plays them in file order
+    for (int job = run->jobCount - 1; job >= 0; job--) {
+        Deque *deque = &workers[job % threads].deque;
+        deque->jobs[deque->back++] = job;
+    }
+
+    double start = now_seconds();
+    int started = 0;
+    for (; started < threads; started++) {
+        args[started].run = run;
+        args[started].worker = &workers[started];
+        if (pthread_create(&workers[started].thread, NULL, worker_main, &args[started]) != 0) {
+            printf("Could not start thread %d\n", started);
+            break;
+        }
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    double seconds = now_seconds() - start;
+
+    // A thread that failed to start leaves its deque for the others to
+    // steal, so the results are complete as long as one thread ran
+    if (started == 0) seconds = -1;
+
+    for (int i = 0; i < threads; i++) {
+        pthread_mutex_destroy(&workers[i].deque.lock);
+        free(workers[i].deque.jobs);
+    }
+    return seconds;
+}
+
+static void report_run(const Run *run, double seconds) {
+    long long ticks = 0;
+    for (int i = 0; i < run->workerCount; i++) {
+        ticks += run->workers[i].ticks;
+    }
+
+    printf("%d matches on %d threads in %.3f s: %.1f matches/sec, %.0f ticks/sec\n",
+           run->jobCount, run->workerCount, seconds,
+           run->jobCount / seconds, ticks / seconds);
+    for (int i = 0; i < run->workerCount; i++) {
+        const Worker *worker = &run->workers[i];
+        printf("  thread %-3d %5.1f%% busy %8ld matches %6ld stolen\n",
+               i, 100.0 * worker->busy / seconds, worker->matches, worker->steals);
+    }
+}
+
+static bool write_results(const char *path, const Job *jobs, const JobResult *results, int count) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        printf("%s: cannot write\n", path);
+        return false;
+    }
+
+    fprintf(file, "job,line,mode,features,seed,agent,ticks,score1,score2,finished,thread\n");
+    for (int i = 0; i < count; i++) {
+        char features[64];
+        format_features(&jobs[i].features, features, sizeof(features));
+
+        fprintf(file, "%d,%d,%s,%s,%llu,%s,%u,%d,%d,%d,%d\n",
+                i, jobs[i].line, mode_name(jobs[i].mode),
+                jobs[i].mode == MODE_CHALLENGE ? features : "classic",
+                (unsigned long long)jobs[i].seed, jobs[i].agent->name, results[i].ticks,
+                results[i].score[0], results[i].score[1], results[i].finished, results[i].thread);
+    }
+
+    bool ok = fclose(file) == 0;
+    if (!ok) printf("%s: write failed\n", path);
+    return ok;
+}
+
+// Same outcome for every match, ignoring which thread played it
+static bool same_results(const JobResult *a, const JobResult *b, int count) {
+    for (int i = 0; i < count; i++) {
+        if (a[i].ticks != b[i].ticks || a[i].finished != b[i].finished ||
+            a[i].score[0] != b[i].score[0] || a[i].score[1] != b[i].score[1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void usage(const char *program) {
+    printf("Usage: %s [--board WIDTHxHEIGHT] [--threads N] [--max-ticks N] [--scale] "
+           "[--record PREFIX] jobs.txt [results.csv]\n", program);
+}
+
+int main(int argc, char *argv[]) {
+    GameOptions options;
+    if (!parse_options(&options, &argc, argv)) return 1;
+    if (options.hasSeed) {
+        printf("--seed has no effect here, every job has its own seed\n");
+        return 1;
+    }
+
+    int threads = core_count();
+    bool scale = false;
+    const char *job_path = NULL;
+    const char *output_path = DEFAULT_OUTPUT;
+    int positional = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--scale") == 0) {
+            scale = true;
+        } else if (argv[i][0] != '-' && positional == 0) {
+            job_path = argv[i];
+            positional++;
+        } else if (argv[i][0] != '-' && positional == 1) {
+            output_path = argv[i];
+            positional++;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!job_path || threads < 1 || threads > MAX_THREADS) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Run run = {0};
+    run.maxTicks = options.maxTicks;
+    run.width = options.boardWidth;
+    run.height = options.boardHeight;
+    run.recordPrefix = options.recordPath;
+    run.jobs = load_jobs(job_path, &run.jobCount);
+    if (!run.jobs) return 1;
+
+    run.results = calloc(run.jobCount, sizeof(JobResult));
+    JobResult *reference = calloc(run.jobCount, sizeof(JobResult));
+    if (!run.results || !reference) {
+        printf("Out of memory\n");
+        return 1;
+    }
+
+    bool ok = true;
+    if (scale) {
+        double single = 0;
+        for (int count = 1; ok; count = count * 2 < threads ? count * 2 : threads) {
+            double seconds = run_jobs(&run, count);
+            if (seconds < 0) return 1;
+            report_run(&run, seconds);
+
+            if (count == 1) {
+                single = seconds;
+                memcpy(reference, run.results, sizeof(JobResult) * run.jobCount);
+            } else if (!same_results(reference, run.results, run.jobCount)) {
+                printf("Results with %d threads differ from 1 thread\n", count);
+                ok = false;
+            }
+            printf("  speedup %.2fx, efficiency %.0f%%\n\n",
+                   single / seconds, 100.0 * single / seconds / count);
+
+            if (count == threads) break;
+        }
+    } else {
+        double seconds = run_jobs(&run, threads);
+        if (seconds < 0) return 1;
+        report_run(&run, seconds);
+    }
+
+    if (ok) ok = write_results(output_path, run.jobs, run.results, run.jobCount);
+    if (ok) printf("Wrote %s\n", output_path);
+
+    free((void *)run.jobs);
+    free(run.results);
+    free(reference);
+    return ok ? 0 : 1;
+}
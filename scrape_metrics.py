@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+# Scrape the file the game keeps with --metrics, the way Prometheus would,
+# with nothing but Python.
+#
+# Usage: scrape_metrics.py FILE [seconds]   print rates every `seconds` (5)
+#        scrape_metrics.py --once FILE      print every sample and check the
+#                                           format, exit 1 if it is off
+#
+# Rates and frame time percentiles are over the time between two scrapes;
+# the percentiles interpolate within histogram buckets as PromQL's
+# histogram_quantile() does.
+
+import math
+import re
+import sys
+import time
+
+SAMPLE = re.compile(r'^([a-zA-Z_:][a-zA-Z0-9_:]*)(\{[^}]*\})? (\S+)$')
+LABEL = re.compile(r'([a-zA-Z_][a-zA-Z0-9_]*)="([^"]*)"')
+
+
+def parse(text):
+    """Samples as {(name, ((label, value), ...)): float}"""
+    samples = {}
+    types = {}
+    for number, line in enumerate(text.splitlines(), 1):
+        if not line or line.startswith('# HELP '):
+            continue
+        if line.startswith('# TYPE '):
+            _, _, name, kind = line.split(' ', 3)
+            types[name] = kind
+            continue
+        match = SAMPLE.match(line)
+        if not match:
+            raise ValueError('line %d: not a sample: %r' % (number, line))
+        name, labels, value = match.groups()
+        family = re.sub(r'_(bucket|sum|count)$', '', name)
+        if name not in types and family not in types:
+            raise ValueError('line %d: %s has no TYPE' % (number, name))
+        key = (name, tuple(sorted(LABEL.findall(labels or ''))))
+        samples[key] = float(value)
+    return samples
+
+
+def read(path):
+    with open(path) as file:
+        return parse(file.read())
+
+
+def value(samples, name, **labels):
+    return samples.get((name, tuple(sorted(labels.items()))), 0.0)
+
+
+def buckets(samples, name):
+    """[(upper bound, cumulative count)] in bound order"""
+    found = [(float(dict(labels)['le']), count) for (sample, labels), count in samples.items()
+             if sample == name + '_bucket']
+    return sorted(found)
+
+
+def quantile(q, bounds):
+    total = bounds[-1][1] if bounds else 0
+    if total <= 0:
+        return math.nan
+    rank = q * total
+    lower_bound, lower_count = 0.0, 0.0
+    for bound, count in bounds:
+        if count >= rank:
+            if math.isinf(bound):
+                return lower_bound
+            return lower_bound + (bound - lower_bound) * (rank - lower_count) / (count - lower_count)
+        lower_bound, lower_count = bound, count
+    return lower_bound
+
+
+def report(before, after, seconds):
+    def rate(name):
+        return (value(after, name) - value(before, name)) / seconds
+
+    old = dict(buckets(before, 'snake_frame_seconds'))
+    frames = [(bound, count - old.get(bound, 0.0)) for bound, count in buckets(after, 'snake_frame_seconds')]
+    p50, p95, p99 = (quantile(q, frames) * 1000 for q in (0.5, 0.95, 0.99))
+
+    games = sum(count for (name, _), count in after.items() if name == 'snake_games_total')
+    resident = value(after, 'process_resident_memory_bytes') / (1024 * 1024)
+    print('%6.1f fps  %6.1f ticks/s  frame p50 %.1f p95 %.1f p99 %.1f ms  %.2f dropped ticks/s  '
+          '%d games  %d underruns  %.1f MB'
+          % (rate('snake_frames_total'), rate('snake_ticks_total'), p50, p95, p99,
+             rate('snake_dropped_ticks_total'), games, value(after, 'snake_audio_underruns_total'),
+             resident))
+
+
+def main(argv):
+    if len(argv) == 3 and argv[1] == '--once':
+        try:
+            samples = read(argv[2])
+        except (OSError, ValueError) as error:
+            print(error)
+            return 1
+        for (name, labels), count in sorted(samples.items()):
+            text = ','.join('%s="%s"' % label for label in labels)
+            print('%s%s %g' % (name, '{%s}' % text if text else '', count))
+        return 0
+
+    if len(argv) not in (2, 3):
+        print('Usage: scrape_metrics.py FILE [seconds] | --once FILE')
+        return 1
+    interval = float(argv[2]) if len(argv) == 3 else 5.0
+
+    before, then = read(argv[1]), time.monotonic()
+    while True:
+        time.sleep(interval)
+        try:
+            after, now = read(argv[1]), time.monotonic()
+        except (OSError, ValueError) as error:
+            print(error)
+            continue
+        report(before, after, now - then)
+        before, then = after, now
+
+
+if __name__ == '__main__':
+    try:
+        sys.exit(main(sys.argv))
+    except KeyboardInterrupt:
+        pass
@@ -0,0 +1,423 @@
+#include "snake_batch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+#define START_LENGTH 5
+#define START_X 5
+#define START_Y 5
+#define FOOD_VALUE 10
+
+// Stamp of a cell no head has entered; below any clock - length
+#define STAMP_EMPTY INT32_MIN
+
+// Lane clocks are pulled back towards 0 once they pass REBASE_CLOCK, checked
+// every REBASE_INTERVAL steps so they never come near overflowing
+#define REBASE_CLOCK (1 << 30)
+#define REBASE_INTERVAL (1 << 20)
+
+// Random food placement tries this many cells before scanning for one
+#define FOOD_ATTEMPTS 64
+
+static int32_t *lane_stamps(const SnakeBatch *batch, int index) {
+    return batch->stamps + (size_t)index * batch->cells;
+}
+
+static bool is_body(const SnakeBatch *batch, int index, int cell) {
+    return lane_stamps(batch, index)[cell] > batch->clock[index] - batch->length[index];
+}
+
+// Put the lane's fruit on a free cell chosen uniformly at random. Random
+// picks find one quickly while the board is mostly free; once they keep
+// hitting the snake, the k-th free cell is taken for a random k instead.
+static void place_batch_food(SnakeBatch *batch, int index) {
+    Rng *rng = &batch->rng[index];
+    int cell = (int)rng_below(rng, (uint32_t)batch->cells);
+
+    for (int i = 0; i < FOOD_ATTEMPTS && is_body(batch, index, cell); i++) {
+        cell = (int)rng_below(rng, (uint32_t)batch->cells);
+    }
+
+    if (is_body(batch, index, cell)) {
+        int freeCells = 0;
+        for (int i = 0; i < batch->cells; i++) {
+            if (!is_body(batch, index, i)) freeCells++;
+        }
+
+        if (freeCells == 0) {
+            // The snake covers the whole board
+            batch->foodX[index] = -1;
+            batch->foodY[index] = -1;
+            batch->events[index] |= EVENT_BOARD_FULL;
+            return;
+        }
+
+        int k = (int)rng_below(rng, (uint32_t)freeCells);
+        for (cell = 0; is_body(batch, index, cell) || k > 0; cell++) {
+            if (!is_body(batch, index, cell)) k--;
+        }
+    }
+
+    batch->foodX[index] = cell % batch->width;
+    batch->foodY[index] = cell / batch->width;
+}
+
+// Shift a lane's clock back to 0, keeping the body and forgetting older stamps
+static void rebase_lane(SnakeBatch *batch, int index) {
+    int32_t *stamps = lane_stamps(batch, index);
+    int32_t shift = batch->clock[index];
+
+    for (int cell = 0; cell < batch->cells; cell++) {
+        stamps[cell] = is_body(batch, index, cell) ? stamps[cell] - shift : STAMP_EMPTY;
+    }
+    batch->clock[index] = 0;
+}
+
+static void *take(unsigned char **cursor, size_t size) {
+    void *block = *cursor;
+    *cursor += (size + 31) & ~(size_t)31; // Keep every array 32-byte aligned
+    return block;
+}
+
+SnakeBatch *create_batch(int count, int width, int height, uint64_t seed) {
+    if (count <= 0 || width < MIN_GRID_WIDTH || width > MAX_GRID_SIZE ||
+        height < MIN_GRID_HEIGHT || height > MAX_GRID_SIZE) {
+        return NULL;
+    }
+
+    int lanes = (count + BATCH_LANES - 1) / BATCH_LANES * BATCH_LANES;
+    size_t cells = (size_t)width * height;
+
+    // Gathers index the stamps with 32-bit offsets
+    if ((size_t)lanes * cells > INT32_MAX) return NULL;
+
+    SnakeBatch *batch = calloc(1, sizeof(SnakeBatch));
+    if (!batch) return NULL;
+
+    size_t lane_size = ((size_t)lanes * sizeof(int32_t) + 31) & ~(size_t)31;
+    size_t rng_size = ((size_t)lanes * sizeof(Rng) + 31) & ~(size_t)31;
+    size_t size = 11 * lane_size + rng_size + (size_t)lanes * cells * sizeof(int32_t) + 31;
+    batch->block = malloc(size);
+    if (!batch->block) {
+        free(batch);
+        return NULL;
+    }
+
+    unsigned char *cursor = (unsigned char *)(((uintptr_t)batch->block + 31) & ~(uintptr_t)31);
+    batch->headX = take(&cursor, lane_size);
+    batch->headY = take(&cursor, lane_size);
+    batch->dirX = take(&cursor, lane_size);
+    batch->dirY = take(&cursor, lane_size);
+    batch->length = take(&cursor, lane_size);
+    batch->alive = take(&cursor, lane_size);
+    batch->foodX = take(&cursor, lane_size);
+    batch->foodY = take(&cursor, lane_size);
+    batch->score = take(&cursor, lane_size);
+    batch->clock = take(&cursor, lane_size);
+    batch->events = take(&cursor, lane_size);
+    batch->rng = take(&cursor, rng_size);
+    batch->stamps = take(&cursor, (size_t)lanes * cells * sizeof(int32_t));
+
+    batch->count = count;
+    batch->lanes = lanes;
+    batch->width = width;
+    batch->height = height;
+    batch->cells = (int)cells;
+
+    // The per-lane arrays are laid out back to back; padding lanes stay
+    // zeroed, i.e. dead
+    memset(batch->headX, 0, 11 * lane_size);
+    for (size_t i = 0; i < (size_t)lanes * cells; i++) {
+        batch->stamps[i] = STAMP_EMPTY;
+    }
+
+    for (int i = 0; i < lanes; i++) {
+        rng_seed(&batch->rng[i], seed, (uint64_t)i);
+    }
+    for (int i = 0; i < count; i++) {
+        reset_batch_game(batch, i);
+    }
+
+    return batch;
+}
+
+void free_batch(SnakeBatch *batch) {
+    if (!batch) return;
+    free(batch->block);
+    free(batch);
+}
+
+void reset_batch_game(SnakeBatch *batch, int index) {
+    if (batch->clock[index] > REBASE_CLOCK) {
+        rebase_lane(batch, index);
+    }
+
+    // Jump the clock past every stamp of the last game, which frees the
+    // whole board without touching it
+    int32_t clock = batch->clock[index] + START_LENGTH;
+    int32_t *stamps = lane_stamps(batch, index);
+
+    batch->clock[index] = clock;
+    batch->length[index] = START_LENGTH;
+    batch->headX[index] = START_X;
+    batch->headY[index] = START_Y;
+    batch->dirX[index] = 1;
+    batch->dirY[index] = 0;
+    batch->alive[index] = -1;
+    batch->score[index] = 0;
+    batch->events[index] = 0;
+
+    // Body trails to the left of the head, newest stamp at the head
+    for (int i = 0; i < START_LENGTH; i++) {
+        stamps[START_Y * batch->width + START_X - i] = clock - i;
+    }
+
+    place_batch_food(batch, index);
+}
+
+// Apply this tick's turns; reversing straight into the body is ignored
+static void turn_lanes(SnakeBatch *batch, const Direction *input) {
+    static const int32_t turn_dx[] = {0, 0, 0, -1, 1};
+    static const int32_t turn_dy[] = {0, -1, 1, 0, 0};
+
+    if (!input) return;
+
+    for (int i = 0; i < batch->count; i++) {
+        Direction dir = input[i];
+        if (dir == DIR_NONE) continue;
+
+        int32_t dx = turn_dx[dir];
+        int32_t dy = turn_dy[dir];
+        if (dx == -batch->dirX[i] && dy == -batch->dirY[i]) continue;
+
+        batch->dirX[i] = dx;
+        batch->dirY[i] = dy;
+    }
+}
+
+// Reference kernel: one lane at a time, same order of checks as move_snake()
+static void step_lanes_scalar(SnakeBatch *batch, int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        batch->events[i] = 0;
+        if (!batch->alive[i]) continue;
+
+        int32_t clock = ++batch->clock[i];
+        int32_t x = batch->headX[i] + batch->dirX[i];
+        int32_t y = batch->headY[i] + batch->dirY[i];
+        batch->headX[i] = x;
+        batch->headY[i] = y;
+
+        // Walls, then the body
+        if (x < 0 || x >= batch->width || y < 0 || y >= batch->height ||
+            is_body(batch, i, y * batch->width + x)) {
+            batch->alive[i] = 0;
+            batch->events[i] = EVENT_DIED;
+            continue;
+        }
+
+        lane_stamps(batch, i)[y * batch->width + x] = clock;
+
+        if (x == batch->foodX[i] && y == batch->foodY[i]) {
+            batch->score[i] += FOOD_VALUE;
+            batch->length[i]++;
+            batch->events[i] = EVENT_ATE;
+            place_batch_food(batch, i);
+        }
+    }
+}
+
+#if defined(__AVX2__)
+
+#define KERNEL_NAME "avx2"
+
+static void step_lanes(SnakeBatch *batch) {
+    const __m256i width = _mm256_set1_epi32(batch->width);
+    const __m256i height = _mm256_set1_epi32(batch->height);
+    const __m256i minus_one = _mm256_set1_epi32(-1);
+    const __m256i empty = _mm256_set1_epi32(STAMP_EMPTY);
+    const __m256i food_value = _mm256_set1_epi32(FOOD_VALUE);
+    const __m256i died_flag = _mm256_set1_epi32(EVENT_DIED);
+    const __m256i ate_flag = _mm256_set1_epi32(EVENT_ATE);
+    const __m256i lane_step = _mm256_set1_epi32(BATCH_LANES * batch->cells);
+
+    // Offset of each lane's stamps from the start of the block
+    __m256i base = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                      _mm256_set1_epi32(batch->cells));
+
+    for (int i = 0; i < batch->lanes; i += BATCH_LANES, base = _mm256_add_epi32(base, lane_step)) {
+        __m256i alive = _mm256_load_si256((const __m256i *)&batch->alive[i]);
+        _mm256_store_si256((__m256i *)&batch->events[i], _mm256_setzero_si256());
+        if (_mm256_testz_si256(alive, alive)) continue;
+
+        // Move: alive lanes step, dead ones keep their state
+        __m256i clock = _mm256_sub_epi32(_mm256_load_si256((const __m256i *)&batch->clock[i]), alive);
+        __m256i x = _mm256_add_epi32(_mm256_load_si256((const __m256i *)&batch->headX[i]),
+                                     _mm256_and_si256(_mm256_load_si256((const __m256i *)&batch->dirX[i]), alive));
+        __m256i y = _mm256_add_epi32(_mm256_load_si256((const __m256i *)&batch->headY[i]),
+                                     _mm256_and_si256(_mm256_load_si256((const __m256i *)&batch->dirY[i]), alive));
+
+        // Walls
+        __m256i inside = _mm256_and_si256(
+            _mm256_and_si256(_mm256_cmpgt_epi32(x, minus_one), _mm256_cmpgt_epi32(width, x)),
+            _mm256_and_si256(_mm256_cmpgt_epi32(y, minus_one), _mm256_cmpgt_epi32(height, y)));
+        __m256i died = _mm256_andnot_si256(inside, alive);
+        alive = _mm256_and_si256(alive, inside);
+
+        // Body: gather the stamp of the cell each head moves into
+        __m256i cell = _mm256_add_epi32(_mm256_mullo_epi32(y, width), x);
+        __m256i index = _mm256_add_epi32(base, _mm256_and_si256(cell, alive));
+        __m256i stamp = _mm256_mask_i32gather_epi32(empty, batch->stamps, index, alive, 4);
+        __m256i limit = _mm256_sub_epi32(clock, _mm256_load_si256((const __m256i *)&batch->length[i]));
+        __m256i hit = _mm256_and_si256(_mm256_cmpgt_epi32(stamp, limit), alive);
+        died = _mm256_or_si256(died, hit);
+        alive = _mm256_andnot_si256(hit, alive);
+
+        _mm256_store_si256((__m256i *)&batch->clock[i], clock);
+        _mm256_store_si256((__m256i *)&batch->headX[i], x);
+        _mm256_store_si256((__m256i *)&batch->headY[i], y);
+        _mm256_store_si256((__m256i *)&batch->alive[i], alive);
+
+        // Stamp the new heads; AVX2 has no scatter
+        int live = _mm256_movemask_ps(_mm256_castsi256_ps(alive));
+        if (live) {
+            int32_t cells[BATCH_LANES], clocks[BATCH_LANES];
+            _mm256_storeu_si256((__m256i *)cells, index);
+            _mm256_storeu_si256((__m256i *)clocks, clock);
+            for (int lane = 0; lane < BATCH_LANES; lane++) {
+                if (live & (1 << lane)) batch->stamps[cells[lane]] = clocks[lane];
+            }
+        }
+
+        // Fruit
+        __m256i ate = _mm256_and_si256(alive, _mm256_and_si256(
+            _mm256_cmpeq_epi32(x, _mm256_load_si256((const __m256i *)&batch->foodX[i])),
+            _mm256_cmpeq_epi32(y, _mm256_load_si256((const __m256i *)&batch->foodY[i]))));
+        __m256i score = _mm256_add_epi32(_mm256_load_si256((const __m256i *)&batch->score[i]),
+                                         _mm256_and_si256(ate, food_value));
+        __m256i length = _mm256_sub_epi32(_mm256_load_si256((const __m256i *)&batch->length[i]), ate);
+        _mm256_store_si256((__m256i *)&batch->score[i], score);
+        _mm256_store_si256((__m256i *)&batch->length[i], length);
+        _mm256_store_si256((__m256i *)&batch->events[i],
+                           _mm256_or_si256(_mm256_and_si256(died, died_flag), _mm256_and_si256(ate, ate_flag)));
+
+        int eaten = _mm256_movemask_ps(_mm256_castsi256_ps(ate));
+        for (int lane = 0; eaten; lane++, eaten >>= 1) {
+            if (eaten & 1) place_batch_food(batch, i + lane);
+        }
+    }
+}
+
+#elif defined(__SSE4_1__)
+
+#define KERNEL_NAME "sse4.1"
+
+// Same as the AVX2 kernel four lanes at a time, with the body lookup done
+// lane by lane since SSE has no gather
+static void step_lanes(SnakeBatch *batch) {
+    const __m128i width = _mm_set1_epi32(batch->width);
+    const __m128i height = _mm_set1_epi32(batch->height);
+    const __m128i minus_one = _mm_set1_epi32(-1);
+    const __m128i food_value = _mm_set1_epi32(FOOD_VALUE);
+    const __m128i died_flag = _mm_set1_epi32(EVENT_DIED);
+    const __m128i ate_flag = _mm_set1_epi32(EVENT_ATE);
+
+    for (int i = 0; i < batch->lanes; i += 4) {
+        __m128i alive = _mm_load_si128((const __m128i *)&batch->alive[i]);
+        _mm_store_si128((__m128i *)&batch->events[i], _mm_setzero_si128());
+        if (_mm_testz_si128(alive, alive)) continue;
+
+        // Move: alive lanes step, dead ones keep their state
+        __m128i clock = _mm_sub_epi32(_mm_load_si128((const __m128i *)&batch->clock[i]), alive);
+        __m128i x = _mm_add_epi32(_mm_load_si128((const __m128i *)&batch->headX[i]),
+                                  _mm_and_si128(_mm_load_si128((const __m128i *)&batch->dirX[i]), alive));
+        __m128i y = _mm_add_epi32(_mm_load_si128((const __m128i *)&batch->headY[i]),
+                                  _mm_and_si128(_mm_load_si128((const __m128i *)&batch->dirY[i]), alive));
+
+        // Walls
+        __m128i inside = _mm_and_si128(
+            _mm_and_si128(_mm_cmpgt_epi32(x, minus_one), _mm_cmpgt_epi32(width, x)),
+            _mm_and_si128(_mm_cmpgt_epi32(y, minus_one), _mm_cmpgt_epi32(height, y)));
+        __m128i died = _mm_andnot_si128(inside, alive);
+        alive = _mm_and_si128(alive, inside);
+
+        _mm_store_si128((__m128i *)&batch->clock[i], clock);
+        _mm_store_si128((__m128i *)&batch->headX[i], x);
+        _mm_store_si128((__m128i *)&batch->headY[i], y);
+
+        // Body, then stamp the new heads
+        int32_t cells[4], lanes_alive[4], lanes_died[4];
+        _mm_storeu_si128((__m128i *)cells, _mm_add_epi32(_mm_mullo_epi32(y, width), x));
+        _mm_storeu_si128((__m128i *)lanes_alive, alive);
+        _mm_storeu_si128((__m128i *)lanes_died, died);
+        for (int lane = 0; lane < 4; lane++) {
+            if (!lanes_alive[lane]) continue;
+            if (is_body(batch, i + lane, cells[lane])) {
+                lanes_alive[lane] = 0;
+                lanes_died[lane] = -1;
+            } else {
+                lane_stamps(batch, i + lane)[cells[lane]] = batch->clock[i + lane];
+            }
+        }
+        alive = _mm_loadu_si128((const __m128i *)lanes_alive);
+        died = _mm_loadu_si128((const __m128i *)lanes_died);
+        _mm_store_si128((__m128i *)&batch->alive[i], alive);
+
+        // Fruit
+        __m128i ate = _mm_and_si128(alive, _mm_and_si128(
+            _mm_cmpeq_epi32(x, _mm_load_si128((const __m128i *)&batch->foodX[i])),
+            _mm_cmpeq_epi32(y, _mm_load_si128((const __m128i *)&batch->foodY[i]))));
+        __m128i score = _mm_add_epi32(_mm_load_si128((const __m128i *)&batch->score[i]),
+                                      _mm_and_si128(ate, food_value));
+        __m128i length = _mm_sub_epi32(_mm_load_si128((const __m128i *)&batch->length[i]), ate);
+        _mm_store_si128((__m128i *)&batch->score[i], score);
+        _mm_store_si128((__m128i *)&batch->length[i], length);
+        _mm_store_si128((__m128i *)&batch->events[i],
+                        _mm_or_si128(_mm_and_si128(died, died_flag), _mm_and_si128(ate, ate_flag)));
+
+        int eaten = _mm_movemask_ps(_mm_castsi128_ps(ate));
+        for (int lane = 0; eaten; lane++, eaten >>= 1) {
+            if (eaten & 1) place_batch_food(batch, i + lane);
+        }
+    }
+}
+
+#else
+
+#define KERNEL_NAME "scalar"
+
+static void step_lanes(SnakeBatch *batch) {
+    step_lanes_scalar(batch, 0, batch->lanes);
+}
+
+#endif
+
+static void finish_step(SnakeBatch *batch) {
+    // Every so often, pull clocks that have run a long way back to 0
+    if (++batch->steps % REBASE_INTERVAL != 0) return;
+
+    for (int i = 0; i < batch->count; i++) {
+        if (batch->clock[i] > REBASE_CLOCK) rebase_lane(batch, i);
+    }
+}
+
+void step_batch(SnakeBatch *batch, const Direction *input) {
+    turn_lanes(batch, input);
+    step_lanes(batch);
+    finish_step(batch);
+}
+
+void step_batch_scalar(SnakeBatch *batch, const Direction *input) {
+    turn_lanes(batch, input);
+    step_lanes_scalar(batch, 0, batch->lanes);
+    finish_step(batch);
+}
+
+const char *batch_kernel_name(void) {
+    return KERNEL_NAME;
+}
@@ -0,0 +1,72 @@
+#ifndef SNAKE_BATCH_H
+#define SNAKE_BATCH_H
+
+#include <stdint.h>
+
+#include "snake_sim.h"
+
+// Many independent classic (single player) games stepped in lockstep, for
+// bots and balance testing. State is kept as structure-of-arrays, one lane
+// per game, so movement, wall and fruit checks run as SIMD kernels (AVX2 or
+// SSE4.1 when the compiler targets them, plain C otherwise).
+//
+// Rules match MODE_SINGLE in snake_sim.c: the snake starts 5 long at (5, 5)
+// heading right, a fruit is worth 10 points and grows the snake by one,
+// hitting a wall or the snake's own body ends the game, and fruit spawns on
+// a free cell chosen uniformly at random. The random draws differ from
+// snake_sim.c's, so a batch lane and a Game on the same seed play different
+// games.
+//
+// Bodies are not stored segment by segment. Each lane has a clock that
+// advances once per tick, and every cell remembers the clock value at which
+// a head last entered it; a cell is part of the body while
+//     stamp > clock - length
+// which makes the self-collision test a single gather.
+
+// Lanes are padded to a multiple of this; padding lanes are always dead
+#define BATCH_LANES 8
+
+typedef struct {
+    int count;    // Games in the batch
+    int lanes;    // count rounded up to BATCH_LANES
+    int width, height, cells;
+
+    // One entry per lane, BATCH_LANES-aligned
+    int32_t *headX, *headY;
+    int32_t *dirX, *dirY;
+    int32_t *length;
+    int32_t *alive;   // -1 (all bits set) while alive, 0 once dead
+    int32_t *foodX, *foodY;  // -1 when the board is full
+    int32_t *score;
+    int32_t *clock;
+    uint32_t *events; // EVENT_* flags from the last step
+
+    int32_t *stamps;  // lanes * cells entry clocks, lane-major
+    Rng *rng;         // Fruit placement, one generator per lane
+
+    unsigned steps;   // Steps taken, for the periodic clock rebase
+
+    void *block;      // Single allocation behind all of the above
+} SnakeBatch;
+
+// Allocate a batch of `count` games on a width x height board, each one
+// reset and ready to play. Lane i draws from stream i of `seed`, so a batch
+// replays exactly from its seed whichever kernel steps it. Returns NULL if
+// the size is out of range or the allocation fails.
+SnakeBatch *create_batch(int count, int width, int height, uint64_t seed);
+void free_batch(SnakeBatch *batch);
+
+// Start game `index` over
+void reset_batch_game(SnakeBatch *batch, int index);
+
+// Advance every live game one tick. `input` holds one direction per game
+// (DIR_NONE keeps going) and may be NULL. step_batch() uses the widest
+// kernel compiled in, step_batch_scalar() the plain C reference; both give
+// identical results.
+void step_batch(SnakeBatch *batch, const Direction *input);
+void step_batch_scalar(SnakeBatch *batch, const Direction *input);
+
+// "avx2", "sse4.1" or "scalar"
+const char *batch_kernel_name(void);
+
+#endif
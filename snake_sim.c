@@ -0,0 +1,836 @@
+#include "snake_sim.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+
+// All randomness in the simulation goes through here. Each game has its own
+// generator so games can run side by side on different threads and replay
+// from a seed.
+static int random_int(Game *game, int n) {
+    return (int)rng_below(&game->rng, (uint32_t)n);
+}
+
+static bool is_outside(const Game *game, int x, int y) {
+    return x < 0 || x >= game->width || y < 0 || y >= game->height;
+}
+
+static bool is_on_obstacle(const Game *game, int x, int y) {
+    return bitboard_test(&game->obstacleCells, cell_index(game, x, y));
+}
+
+static bool is_on_food(const Game *game, int x, int y) {
+    return bitboard_test(&game->foodCells, cell_index(game, x, y));
+}
+
+// Note that a cell looks different now
+static void mark_dirty(Game *game, int cell) {
+    if (game->dirtyCount < MAX_DIRTY_CELLS) {
+        game->dirtyCells[game->dirtyCount++] = cell;
+    } else {
+        game->dirtyOverflow = true;
+    }
+}
+
+// Mark a cell in one of the occupancy layers, taking it out of the free set
+static void occupy_cell(Game *game, Bitboard *layer, int cell) {
+    bitboard_set(layer, cell);
+    mark_dirty(game, cell);
+
+    int slot = game->freeSlot[cell];
+    if (slot < 0) return;
+
+    // Swap-remove: move the last free cell into the vacated slot
+    int last = game->freeCells[--game->freeCount];
+    game->freeCells[slot] = last;
+    bitboard_set(&game->movedSlots, slot);
+    game->freeSlot[last] = slot;
+    game->freeSlot[cell] = -1;
+}
+
+// Clear a cell in one layer, returning it to the free set if nothing else
+// covers it
+static void release_cell(Game *game, Bitboard *layer, int cell) {
+    bitboard_clear(layer, cell);
+    mark_dirty(game, cell);
+
+    if (game->freeSlot[cell] >= 0 ||
+        bitboard_test(&game->snakeCells, cell) ||
+        bitboard_test(&game->obstacleCells, cell) ||
+        bitboard_test(&game->foodCells, cell)) {
+        return;
+    }
+
+    bitboard_set(&game->movedSlots, game->freeCount);
+    game->freeSlot[cell] = game->freeCount;
+    game->freeCells[game->freeCount++] = cell;
+}
+
+// Space a block of `size` bytes takes up in the arena, keeping every block
+// 16-byte aligned
+static size_t arena_block_size(size_t size) {
+    return (size + 15) & ~(size_t)15;
+}
+
+// Carve `size` bytes out of the arena. configure_game() sizes the arena for
+// the board and everything reset_game() asks for, so this cannot run out.
+static void *arena_alloc(Arena *arena, size_t size) {
+    size = arena_block_size(size);
+    void *block = arena->base + arena->used;
+    arena->used += size;
+    return block;
+}
+
+static void init_snake(Game *game, Snake *snake, int length, int x, int y, int dx, int dy) {
+    snake->capacity = game->cells;
+    snake->body = arena_alloc(&game->arena, snake->capacity * sizeof(Segment));
+    snake->head = 0;
+    snake->length = length;
+    snake->dx = dx;
+    snake->dy = dy;
+    snake->alive = true;
+    snake->score = 0;
+
+    // Body trails away from the direction of travel
+    for (int i = 0; i < length; i++) {
+        snake->body[i].x = x - i * dx;
+        snake->body[i].y = y - i * dy;
+        occupy_cell(game, &game->snakeCells, cell_index(game, snake->body[i].x, snake->body[i].y));
+    }
+}
+
+bool configure_game(Game *game, GameMode mode, const GameFeatures *features, int width, int height) {
+    if (width < MIN_GRID_WIDTH || width > MAX_GRID_SIZE ||
+        height < MIN_GRID_HEIGHT || height > MAX_GRID_SIZE) {
+        return false;
+    }
+
+    // Reset config to defaults, holding on to the arena of a previous match
+    // and the random number generator
+    Arena arena = game->arena;
+    Rng rng = game->rng;
+    memset(game, 0, sizeof(Game));
+    game->arena = arena;
+    game->rng = rng;
+    if (game->rng.inc == 0) seed_game(game, 0); // Never seeded
+    game->mode = mode;
+    game->width = width;
+    game->height = height;
+    game->cells = width * height;
+    game->updateDelay = 150; // Normal speed
+
+    switch (mode) {
+        case MODE_SINGLE:
+            game->snakeCount = 1;
+            strcpy(game->modeName, "CLASSIC");
+            break;
+
+        case MODE_CHALLENGE:
+            game->snakeCount = 1;
+            game->features = *features;
+
+            // Apply feature settings
+            game->movingFruit = features->movingFruit;
+            game->multiFruit = features->multiFruit;
+            game->timed = features->timed;
+            game->hasObstacles = features->obstacles;
+            game->movingObstacles = features->obstacles && features->movingFruit; // Only if both are selected
+
+            if (features->speed) {
+                game->updateDelay = 100; // Faster speed
+            }
+
+            // Configure timed mode
+            if (game->timed) {
+                game->timeLimit = 60000; // 60 seconds
+            }
+
+            // Configure food movement
+            if (game->movingFruit) {
+                game->fruitMoveInterval = 500; // Move every 500ms
+            }
+
+            // Configure obstacle movement
+            if (game->movingObstacles) {
+                game->obstacleMoveInterval = 800; // Move every 800ms
+            }
+
+            // Generate a name for this mode configuration
+            generate_mode_name(game, features);
+            break;
+
+        case MODE_MULTI:
+            game->snakeCount = 2;
+            game->timed = true;
+            game->timeLimit = GAME_DURATION;
+            strcpy(game->modeName, "SNAKE BATTLE");
+            break;
+    }
+
+    // Board storage, then room for every snake to fill the board. Untouched
+    // pages of a large block are typically not committed by the OS, so the
+    // real footprint follows the length the snakes actually reach.
+    size_t words = ((size_t)game->cells + 63) / 64;
+    size_t board_size = 4 * arena_block_size(words * sizeof(uint64_t)) +
+                        2 * arena_block_size((size_t)game->cells * sizeof(int));
+    size_t size = board_size + game->snakeCount * arena_block_size((size_t)game->cells * sizeof(Segment));
+    if (game->arena.size < size) {
+        free(game->arena.base);
+        game->arena.base = malloc(size);
+        game->arena.size = game->arena.base ? size : 0;
+        if (!game->arena.base) return false;
+    }
+    game->arena.used = 0;
+
+    game->snakeCells.bits = arena_alloc(&game->arena, words * sizeof(uint64_t));
+    game->obstacleCells.bits = arena_alloc(&game->arena, words * sizeof(uint64_t));
+    game->foodCells.bits = arena_alloc(&game->arena, words * sizeof(uint64_t));
+    game->freeCells = arena_alloc(&game->arena, game->cells * sizeof(int));
+    game->freeSlot = arena_alloc(&game->arena, game->cells * sizeof(int));
+    game->movedSlots.bits = arena_alloc(&game->arena, words * sizeof(uint64_t));
+    game->bodyMark = game->arena.used;
+
+    // Start with an empty board. From here on reset_game() only clears the
+    // cells a match used, which keeps restarts cheap on big boards.
+    memset(game->snakeCells.bits, 0, words * sizeof(uint64_t));
+    memset(game->obstacleCells.bits, 0, words * sizeof(uint64_t));
+    memset(game->foodCells.bits, 0, words * sizeof(uint64_t));
+    memset(game->movedSlots.bits, 0, words * sizeof(uint64_t));
+    for (int cell = 0; cell < game->cells; cell++) {
+        game->freeCells[cell] = cell;
+        game->freeSlot[cell] = cell;
+    }
+    game->freeCount = game->cells;
+
+    return true;
+}
+
+// Take everything the last match put on the board off it again
+static void clear_board(Game *game) {
+    // Dead snakes were taken off when they died
+    for (int i = 0; i < game->snakeCount; i++) {
+        Snake *snake = &game->snakes[i];
+        if (!snake->alive) continue;
+
+        for (int k = 0; k < snake->length; k++) {
+            const Segment *segment = snake_segment(snake, k);
+            release_cell(game, &game->snakeCells, cell_index(game, segment->x, segment->y));
+        }
+        snake->alive = false;
+    }
+
+    for (int i = 0; i < game->foodCount; i++) {
+        remove_food(game, &game->foods[i]);
+    }
+
+    for (int i = 0; i < game->obstacleCount; i++) {
+        const Obstacle *obstacle = &game->obstacles[i];
+        release_cell(game, &game->obstacleCells, cell_index(game, obstacle->x, obstacle->y));
+    }
+
+    // Every cell is free again, but the list is shuffled. Restore the
+    // positions that were written, which is all it takes to get back to
+    // cell order: the rest still hold the cell they started with.
+    size_t words = ((size_t)game->cells + 63) / 64;
+    for (size_t w = 0; w < words; w++) {
+        uint64_t moved = game->movedSlots.bits[w];
+        while (moved) {
+            int slot = (int)(w * 64) + __builtin_ctzll(moved);
+            game->freeCells[slot] = slot;
+            game->freeSlot[slot] = slot;
+            moved &= moved - 1;
+        }
+        game->movedSlots.bits[w] = 0;
+    }
+}
+
+void reset_game(Game *game) {
+    clear_board(game);
+    game->matchRng = game->rng;
+    game->dirtyCount = 0;
+    game->dirtyOverflow = true;
+    game->layout++;
+
+    // Drop the previous match's bodies
+    game->arena.used = game->bodyMark;
+
+    game->tick = 0;
+    game->elapsed = 0;
+    game->over = false;
+    game->lastFruitMove = 0;
+    game->lastObstacleMove = 0;
+    game->obstacleCount = 0;
+    game->foodCount = 0;
+
+    switch (game->mode) {
+        case MODE_SINGLE:
+            init_snake(game, &game->snakes[0], 5, 5, 5, 1, 0);
+
+            game->foodCount = 1;
+            game->foods[0] = (Food){0};
+            game->foods[0].value = 10;
+            place_food(game, &game->foods[0]);
+            break;
+
+        case MODE_CHALLENGE:
+            init_snake(game, &game->snakes[0], 3, game->width / 2, game->height / 2, 1, 0);
+
+            // Place obstacles
+            if (game->hasObstacles) {
+                place_obstacles(game);
+            }
+
+            // Place food items
+            initialize_multi_fruits(game);
+            break;
+
+        case MODE_MULTI:
+            // Snake A on the left, snake B on the right heading towards it
+            init_snake(game, &game->snakes[0], 3, 5, 5, 1, 0);
+            init_snake(game, &game->snakes[1], 3, game->width - 6, game->height - 6, -1, 0);
+
+            game->foodCount = FRUIT_COUNT * 2;
+            for (int i = 0; i < game->foodCount; i++) {
+                game->foods[i] = (Food){0};
+                game->foods[i].value = 10;
+            }
+
+            // Place initial fruits
+            ensure_minimum_fruits(game);
+            break;
+    }
+}
+
+void seed_game(Game *game, uint64_t seed) {
+    rng_seed(&game->rng, seed, 0);
+}
+
+void free_game(Game *game) {
+    free(game->arena.base);
+    game->arena = (Arena){0};
+}
+
+// The same place in `to` as `pointer` has in the arena of `from`; pointers
+// left over from an earlier match (past `used`) become NULL
+static void *relocate(const void *pointer, const Game *from, unsigned char *to) {
+    const unsigned char *p = pointer;
+    if (!p || p < from->arena.base || p >= from->arena.base + from->arena.used) return NULL;
+    return to + (p - from->arena.base);
+}
+
+bool copy_game(Game *copy, const Game *game) {
+    if (copy == game) return true;
+
+    unsigned char *base = copy->arena.base;
+    size_t size = copy->arena.size;
+    if (size < game->arena.size) {
+        base = malloc(game->arena.size);
+        if (!base) return false;
+        free(copy->arena.base);
+        size = game->arena.size;
+    }
+    if (game->arena.used > 0) memcpy(base, game->arena.base, game->arena.used);
+
+    *copy = *game;
+    copy->arena = (Arena){base, size, game->arena.used};
+    copy->snakeCells.bits = relocate(game->snakeCells.bits, game, base);
+    copy->obstacleCells.bits = relocate(game->obstacleCells.bits, game, base);
+    copy->foodCells.bits = relocate(game->foodCells.bits, game, base);
+    copy->movedSlots.bits = relocate(game->movedSlots.bits, game, base);
+    copy->freeCells = relocate(game->freeCells, game, base);
+    copy->freeSlot = relocate(game->freeSlot, game, base);
+    for (int i = 0; i < MAX_SNAKES; i++) {
+        copy->snakes[i].body = relocate(game->snakes[i].body, game, base);
+    }
+    return true;
+}
+
+void generate_mode_name(Game *game, const GameFeatures *features) {
+    strcpy(game->modeName, "");
+
+    // Check if chaos mode (everything enabled)
+    if (features->movingFruit && features->multiFruit && features->timed &&
+        features->obstacles && features->speed) {
+        strcpy(game->modeName, "CHAOS MODE");
+        return;
+    }
+
+    // Otherwise, build the name based on enabled features
+    if (!features->movingFruit && !features->multiFruit && !features->timed &&
+        !features->obstacles && !features->speed) {
+        strcpy(game->modeName, "CLASSIC");
+        return;
+    }
+
+    // Build the name from enabled features
+    bool addedFeature = false;
+
+    if (features->speed) {
+        strcat(game->modeName, "SPEED");
+        addedFeature = true;
+    }
+
+    if (features->timed) {
+        if (addedFeature) strcat(game->modeName, "+");
+        strcat(game->modeName, "TIMED");
+        addedFeature = true;
+    }
+
+    if (features->obstacles) {
+        if (addedFeature) strcat(game->modeName, "+");
+        if (features->movingFruit) {
+            strcat(game->modeName, "MVG-");
+        }
+        strcat(game->modeName, "OBSTACLE");
+        addedFeature = true;
+    }
+
+    if (features->multiFruit) {
+        if (addedFeature) strcat(game->modeName, "+");
+        strcat(game->modeName, "MULTI-FRUIT");
+    } else if (features->movingFruit) {
+        if (addedFeature) strcat(game->modeName, "+");
+        strcat(game->modeName, "MVG-FRUIT");
+    }
+}
+
+// Advance the game by one tick
+GameEvents step_game(Game *game, const GameInput *input) {
+    GameEvents events = {0};
+    if (game->over) return events;
+
+    TRACE_BEGIN(step);
+    game->tick++;
+    game->elapsed += game->updateDelay;
+
+    // Apply the requested turns
+    if (input) {
+        for (int i = 0; i < game->snakeCount; i++) {
+            turn_snake(&game->snakes[i], input->dir[i]);
+        }
+    }
+
+    // Move snakes in order, each one sees the others' updated bodies
+    TRACE_BEGIN(moving);
+    for (int i = 0; i < game->snakeCount; i++) {
+        if (game->snakes[i].alive && !move_snake(game, i)) {
+            events.snake[i] |= EVENT_DIED;
+        }
+    }
+    TRACE_END(moving, "move_snake");
+
+    // Check for food collisions
+    TRACE_BEGIN(eating);
+    bool board_full = false;
+    for (int f = 0; f < game->foodCount; f++) {
+        Food *food = &game->foods[f];
+
+        for (int i = 0; i < game->snakeCount; i++) {
+            Snake *snake = &game->snakes[i];
+            if (!check_food_collision(snake, food)) continue;
+
+            snake->score += food->value;
+            grow_snake(snake);
+            events.snake[i] |= EVENT_ATE;
+
+            // Multiplayer respawns fruits in bulk below, the other modes
+            // replace the eaten one straight away
+            if (game->mode == MODE_MULTI) {
+                remove_food(game, food);
+            } else if (!place_food(game, food)) {
+                board_full = true;
+            }
+            break;
+        }
+    }
+
+    if (game->mode == MODE_MULTI && !ensure_minimum_fruits(game)) {
+        board_full = true;
+    }
+    TRACE_END(eating, "food collisions");
+
+    // Update game elements (moving fruits, obstacles, timer)
+    TRACE_BEGIN(updating);
+    update_game(game);
+    TRACE_END(updating, "update_game");
+
+    // Check if game over
+    if (game->mode == MODE_MULTI) {
+        if (!game->snakes[0].alive && !game->snakes[1].alive) {
+            game->over = true;
+        }
+    } else if (!game->snakes[0].alive) {
+        game->over = true;
+    }
+
+    for (int i = 0; i < game->snakeCount; i++) {
+        events.flags |= events.snake[i];
+    }
+    if (board_full) {
+        events.flags |= EVENT_BOARD_FULL;
+    }
+    if (game->over) {
+        events.flags |= EVENT_GAME_OVER;
+    }
+
+    TRACE_END(step, "step_game");
+    return events;
+}
+
+void turn_snake(Snake *snake, Direction dir) {
+    // Prevent moving directly backwards
+    switch (dir) {
+        case DIR_UP:
+            if (snake->dy != 1) {
+                snake->dx = 0;
+                snake->dy = -1;
+            }
+            break;
+        case DIR_DOWN:
+            if (snake->dy != -1) {
+                snake->dx = 0;
+                snake->dy = 1;
+            }
+            break;
+        case DIR_LEFT:
+            if (snake->dx != 1) {
+                snake->dx = -1;
+                snake->dy = 0;
+            }
+            break;
+        case DIR_RIGHT:
+            if (snake->dx != -1) {
+                snake->dx = 1;
+                snake->dy = 0;
+            }
+            break;
+        case DIR_NONE:
+            break;
+    }
+}
+
+bool move_snake(Game *game, int index) {
+    Snake *snake = &game->snakes[index];
+    if (!snake->alive) return false; // Don't move dead snakes
+
+    Segment old_tail = *snake_tail(snake);
+
+    // The old head is drawn as body from now on
+    mark_dirty(game, cell_index(game, snake->body[snake->head].x, snake->body[snake->head].y));
+
+    // Step the head index back one slot; the old tail slot falls out of
+    // the body (or is overwritten when the buffer is full)
+    int x = snake->body[snake->head].x + snake->dx;
+    int y = snake->body[snake->head].y + snake->dy;
+
+    snake->head = (snake->head == 0 ? snake->capacity : snake->head) - 1;
+    snake->body[snake->head].x = x;
+    snake->body[snake->head].y = y;
+
+    // Free the cell the tail left, unless a freshly grown segment still
+    // sits on it
+    const Segment *new_tail = snake_tail(snake);
+    if (new_tail->x != old_tail.x || new_tail->y != old_tail.y) {
+        release_cell(game, &game->snakeCells, cell_index(game, old_tail.x, old_tail.y));
+    }
+
+    // Check wall collision
+    if (is_outside(game, x, y)) {
+        kill_snake(game, index);
+        return false;
+    }
+
+    // Check collision with itself, other live snakes and obstacles
+    int cell = cell_index(game, x, y);
+    if (bitboard_test(&game->snakeCells, cell) || check_obstacle_collision(game, snake)) {
+        kill_snake(game, index);
+        return false;
+    }
+
+    occupy_cell(game, &game->snakeCells, cell);
+    return true;
+}
+
+// Mark a snake dead and take its body off the board. The head is left
+// alone: it never made it onto the board, it crashed into something
+// that owns that cell.
+void kill_snake(Game *game, int index) {
+    Snake *snake = &game->snakes[index];
+    snake->alive = false;
+
+    for (int i = 1; i < snake->length; i++) {
+        const Segment *segment = snake_segment(snake, i);
+        release_cell(game, &game->snakeCells, cell_index(game, segment->x, segment->y));
+    }
+}
+
+void grow_snake(Snake *snake) {
+    if (snake->length < snake->capacity) {
+        // The new segment is initially placed at the same position as the last segment
+        // It will move correctly in the next tick
+        snake->body[snake_index(snake, snake->length)] = *snake_tail(snake);
+        snake->length++;
+    }
+}
+
+bool check_food_collision(const Snake *snake, const Food *food) {
+    const Segment *head = snake_head(snake);
+    return snake->alive && food->active && head->x == food->x && head->y == food->y;
+}
+
+bool check_obstacle_collision(const Game *game, const Snake *snake) {
+    const Segment *head = snake_head(snake);
+    return is_on_obstacle(game, head->x, head->y);
+}
+
+bool is_cell_free(const Game *game, int x, int y) {
+    int cell = cell_index(game, x, y);
+    return !bitboard_test(&game->snakeCells, cell) &&
+           !bitboard_test(&game->obstacleCells, cell) &&
+           !bitboard_test(&game->foodCells, cell);
+}
+
+// Put a fruit on a uniformly chosen free cell. Returns false, leaving the
+// fruit inactive, when the board is full.
+bool place_food(Game *game, Food *food) {
+    // Take the fruit off its old cell first
+    remove_food(game, food);
+
+    if (game->freeCount == 0) return false;
+
+    int cell = game->freeCells[random_int(game, game->freeCount)];
+    food->x = cell % game->width;
+    food->y = cell / game->width;
+    food->active = true;
+    occupy_cell(game, &game->foodCells, cell);
+
+    // For moving fruit
+    if (game->movingFruit && food->moving) {
+        // Randomly assign an initial direction
+        do {
+            food->dx = random_int(game, 3) - 1; // -1, 0, or 1
+            food->dy = random_int(game, 3) - 1; // -1, 0, or 1
+        } while (food->dx == 0 && food->dy == 0); // Ensure it's not stationary
+    }
+
+    return true;
+}
+
+void remove_food(Game *game, Food *food) {
+    if (!food->active) return;
+
+    food->active = false;
+    release_cell(game, &game->foodCells, cell_index(game, food->x, food->y));
+}
+
+void place_obstacles(Game *game) {
+    if (!game->hasObstacles) return;
+
+    const Snake *snake = &game->snakes[0];
+    int count = random_int(game, MAX_OBSTACLES / 2) + (MAX_OBSTACLES / 2); // 15-30 obstacles
+
+    game->obstacleCount = 0;
+    for (int i = 0; i < count && game->freeCount > 0; i++) {
+        int cell;
+        int attempts = 0;
+
+        // Pick free cells until one leaves enough space around the snake's
+        // head; give up on the obstacle if the free cells are all close by
+        do {
+            cell = game->freeCells[random_int(game, game->freeCount)];
+        } while (abs(cell % game->width - snake_head(snake)->x) < 3 &&
+                 abs(cell / game->width - snake_head(snake)->y) < 3 &&
+                 ++attempts < 64);
+        if (attempts == 64) break;
+
+        Obstacle *obstacle = &game->obstacles[i];
+        obstacle->x = cell % game->width;
+        obstacle->y = cell / game->width;
+        occupy_cell(game, &game->obstacleCells, cell);
+
+        // For moving obstacles
+        if (game->movingObstacles && random_int(game, 3) == 0) { // 1/3 chance to be moving
+            obstacle->moving = true;
+            // Randomly assign an initial direction
+            do {
+                obstacle->dx = random_int(game, 3) - 1; // -1, 0, or 1
+                obstacle->dy = random_int(game, 3) - 1; // -1, 0, or 1
+            } while (obstacle->dx == 0 && obstacle->dy == 0);
+        } else {
+            obstacle->moving = false;
+        }
+
+        game->obstacleCount++;
+    }
+}
+
+void initialize_multi_fruits(Game *game) {
+    if (!game->multiFruit) {
+        game->foodCount = 1;
+        game->foods[0] = (Food){0};
+        game->foods[0].type = 0;  // Regular food
+        game->foods[0].value = 1;
+        game->foods[0].moving = game->movingFruit;
+        place_food(game, &game->foods[0]);
+        return;
+    }
+
+    // For multi-fruit mode, place 3-5 fruits
+    int count = random_int(game, 3) + 3; // 3-5 fruits
+
+    game->foodCount = 0;
+    for (int i = 0; i < count; i++) {
+        Food *food = &game->foods[i];
+        *food = (Food){0};
+        food->type = random_int(game, 4); // 0-3 different types
+
+        // Set point value based on type
+        switch (food->type) {
+            case 0: food->value = 1; break;  // Regular
+            case 1: food->value = 2; break;  // Bonus
+            case 2: food->value = 3; break;  // Special
+            case 3: food->value = 5; break;  // Rare
+        }
+
+        // Determine if this fruit should move (if moving fruit is enabled)
+        if (game->movingFruit) {
+            // Higher value fruits are more likely to move
+            food->moving = (random_int(game, 5) < food->type + 2);
+        }
+
+        game->foodCount++;
+        place_food(game, food);
+    }
+}
+
+// Keep exactly two fruits on the board (multiplayer). Returns false if the
+// board is too full to reach two.
+bool ensure_minimum_fruits(Game *game) {
+    int active_count = 0;
+
+    // Count active fruits
+    for (int i = 0; i < game->foodCount; i++) {
+        if (game->foods[i].active) {
+            active_count++;
+        }
+    }
+
+    // If more than 2 exist, deactivate extras
+    for (int i = 0; i < game->foodCount && active_count > 2; i++) {
+        if (game->foods[i].active) {
+            remove_food(game, &game->foods[i]);
+            active_count--;
+        }
+    }
+
+    // If less than 2, spawn new ones
+    for (int i = 0; i < game->foodCount && active_count < 2; i++) {
+        if (!game->foods[i].active) {
+            if (!place_food(game, &game->foods[i])) return false;
+            active_count++;
+        }
+    }
+
+    return true;
+}
+
+void move_foods(Game *game) {
+    if (!game->movingFruit) return;
+
+    for (int i = 0; i < game->foodCount; i++) {
+        Food *food = &game->foods[i];
+        if (!food->moving) continue;
+
+        int new_x = food->x + food->dx;
+        int new_y = food->y + food->dy;
+
+        // Check if the food would go out of bounds and change direction if needed
+        if (new_x < 0 || new_x >= game->width) {
+            food->dx *= -1;
+            new_x = food->x + food->dx;
+        }
+
+        if (new_y < 0 || new_y >= game->height) {
+            food->dy *= -1;
+            new_y = food->y + food->dy;
+        }
+
+        // If no collision with an obstacle or another fruit, update the position
+        if (!is_on_obstacle(game, new_x, new_y) && !is_on_food(game, new_x, new_y)) {
+            release_cell(game, &game->foodCells, cell_index(game, food->x, food->y));
+            occupy_cell(game, &game->foodCells, cell_index(game, new_x, new_y));
+            food->x = new_x;
+            food->y = new_y;
+        } else {
+            // Otherwise, change direction
+            food->dx *= -1;
+            food->dy *= -1;
+        }
+    }
+}
+
+void move_obstacles(Game *game) {
+    if (!game->movingObstacles) return;
+
+    for (int i = 0; i < game->obstacleCount; i++) {
+        Obstacle *obstacle = &game->obstacles[i];
+        if (!obstacle->moving) continue;
+
+        int new_x = obstacle->x + obstacle->dx;
+        int new_y = obstacle->y + obstacle->dy;
+
+        // Check if the obstacle would go out of bounds and change direction if needed
+        if (new_x < 0 || new_x >= game->width) {
+            obstacle->dx *= -1;
+            new_x = obstacle->x + obstacle->dx;
+        }
+
+        if (new_y < 0 || new_y >= game->height) {
+            obstacle->dy *= -1;
+            new_y = obstacle->y + obstacle->dy;
+        }
+
+        // If no collision with other obstacles or food, update the position
+        if (!is_on_obstacle(game, new_x, new_y) && !is_on_food(game, new_x, new_y)) {
+            release_cell(game, &game->obstacleCells, cell_index(game, obstacle->x, obstacle->y));
+            occupy_cell(game, &game->obstacleCells, cell_index(game, new_x, new_y));
+            obstacle->x = new_x;
+            obstacle->y = new_y;
+        } else {
+            // Otherwise, change direction
+            obstacle->dx *= -1;
+            obstacle->dy *= -1;
+        }
+    }
+}
+
+// Timed elements: moving fruits, moving obstacles and the match clock
+void update_game(Game *game) {
+    // Update moving fruits
+    if (game->movingFruit && game->elapsed - game->lastFruitMove > (unsigned)game->fruitMoveInterval) {
+        move_foods(game);
+        game->lastFruitMove = game->elapsed;
+    }
+
+    // Update moving obstacles
+    if (game->movingObstacles && game->elapsed - game->lastObstacleMove > (unsigned)game->obstacleMoveInterval) {
+        move_obstacles(game);
+        game->lastObstacleMove = game->elapsed;
+    }
+
+    // Update timer
+    if (game->timed && game->elapsed >= (unsigned)game->timeLimit) {
+        game->over = true;
+    }
+}
+
+void clear_dirty_cells(Game *game) {
+    game->dirtyCount = 0;
+    game->dirtyOverflow = false;
+}
+
+int get_time_left(const Game *game) {
+    if (!game->timed || game->elapsed >= (unsigned)game->timeLimit) return 0;
+    return game->timeLimit - (int)game->elapsed;
+}
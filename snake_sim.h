@@ -0,0 +1,285 @@
+#ifndef SNAKE_SIM_H
+#define SNAKE_SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rng.h"
+
+// Renderer-free game simulation shared by the single player, challenge and
+// multiplayer front-ends. Nothing in here touches SDL, audio or the clock:
+// time only advances through step_game(), one tick of updateDelay ms at a
+// time, so a headless caller can run as many ticks per second as it likes.
+
+// Board dimensions, chosen per game in configure_game()
+#define DEFAULT_GRID_WIDTH 32  // 640 / 20
+#define DEFAULT_GRID_HEIGHT 24 // 480 / 20
+#define MIN_GRID_WIDTH 16      // Room for both multiplayer snakes
+#define MIN_GRID_HEIGHT 12
+#define MAX_GRID_SIZE 4096     // Largest width or height
+
+// Limits
+#define MAX_SNAKES 2
+#define MAX_OBSTACLES 30
+#define MAX_FOODS 10 // Multiplayer keeps FRUIT_COUNT * 2 slots
+#define MAX_DIRTY_CELLS 128 // Changed cells listed before giving up, see Game
+
+// Multiplayer rules
+#define GAME_DURATION 120000 // 2 minutes in milliseconds
+#define FRUIT_COUNT 5
+
+typedef enum {
+    MODE_SINGLE,
+    MODE_CHALLENGE,
+    MODE_MULTI
+} GameMode;
+
+// Game feature flags (challenge mode)
+typedef struct {
+    bool movingFruit;
+    bool multiFruit;
+    bool timed;
+    bool obstacles;
+    bool speed;
+    bool chaos;
+} GameFeatures;
+
+typedef enum {
+    DIR_NONE,
+    DIR_UP,
+    DIR_DOWN,
+    DIR_LEFT,
+    DIR_RIGHT
+} Direction;
+
+// 16 bits per coordinate is enough for MAX_GRID_SIZE and halves the
+// memory long bodies take
+typedef struct {
+    int16_t x, y;
+} Segment;
+
+// One bit per board cell, indexed by cell_index(). The words live in the
+// game's arena.
+typedef struct {
+    uint64_t *bits;
+} Bitboard;
+
+static inline bool bitboard_test(const Bitboard *board, int cell) {
+    return (board->bits[cell >> 6] >> (cell & 63)) & 1;
+}
+
+static inline void bitboard_set(Bitboard *board, int cell) {
+    board->bits[cell >> 6] |= (uint64_t)1 << (cell & 63);
+}
+
+static inline void bitboard_clear(Bitboard *board, int cell) {
+    board->bits[cell >> 6] &= ~((uint64_t)1 << (cell & 63));
+}
+
+// Bump allocator owned by a Game. Everything a match needs is carved out
+// of one block and handed back in one go by rewinding `used`.
+typedef struct {
+    unsigned char *base;
+    size_t size;
+    size_t used;
+} Arena;
+
+// The body is a circular buffer of `capacity` segments taken from the game's
+// arena: segment 0 (the head) lives at body[head] and segment i at
+// body[(head + i) % capacity]. Moving writes the new head one slot before
+// the old one, so the tail drops off without shifting the rest of the body.
+// The capacity covers the whole board, so growth is never cut short.
+typedef struct {
+    Segment *body;
+    int capacity;
+    int head;
+    int length;
+    int dx, dy;
+    bool alive;
+    int score;
+} Snake;
+
+typedef struct {
+    int x, y;
+    int value;   // Point value
+    int type;    // Visual type
+    bool moving; // Whether it moves
+    int dx, dy;  // Direction for moving fruits
+    bool active; // Whether the slot holds a fruit
+} Food;
+
+typedef struct {
+    int x, y;
+    int dx, dy;  // Direction for moving obstacles
+    bool moving; // Whether it moves
+} Obstacle;
+
+// Buffer slot of segment i, counted from the head (0) to the tail (length - 1)
+static inline int snake_index(const Snake *snake, int i) {
+    int index = snake->head + i;
+    return index >= snake->capacity ? index - snake->capacity : index;
+}
+
+static inline const Segment *snake_segment(const Snake *snake, int i) {
+    return &snake->body[snake_index(snake, i)];
+}
+
+static inline const Segment *snake_head(const Snake *snake) {
+    return &snake->body[snake->head];
+}
+
+static inline const Segment *snake_tail(const Snake *snake) {
+    return snake_segment(snake, snake->length - 1);
+}
+
+// Per-tick input: the direction requested for each snake since the last
+// tick (DIR_NONE keeps the current heading)
+typedef struct {
+    Direction dir[MAX_SNAKES];
+} GameInput;
+
+// Event flags reported by step_game()
+#define EVENT_ATE       (1u << 0) // A snake ate a fruit
+#define EVENT_DIED      (1u << 1) // A snake hit a wall, itself, an obstacle or another snake
+#define EVENT_GAME_OVER (1u << 2) // The match has ended
+#define EVENT_BOARD_FULL (1u << 3) // A fruit could not be placed, no free cell left
+
+typedef struct {
+    unsigned flags;             // Union of all events this tick
+    unsigned snake[MAX_SNAKES]; // Events per snake
+} GameEvents;
+
+typedef struct {
+    GameMode mode;
+    GameFeatures features;
+
+    // Board size in cells
+    int width;
+    int height;
+    int cells;
+
+    // Board storage (occupancy and the free set) followed by the snake
+    // bodies; reset_game() rewinds to bodyMark to drop the bodies
+    Arena arena;
+    size_t bodyMark;
+
+    Snake snakes[MAX_SNAKES];
+    int snakeCount;
+
+    bool hasObstacles;
+    Obstacle obstacles[MAX_OBSTACLES];
+    int obstacleCount;
+    bool movingObstacles;
+    int obstacleMoveInterval;
+    unsigned lastObstacleMove;
+
+    bool movingFruit;
+    int fruitMoveInterval; // How often the fruit moves (in milliseconds)
+    unsigned lastFruitMove; // Time of last fruit movement
+
+    bool multiFruit;
+    Food foods[MAX_FOODS];
+    int foodCount;
+
+    // Occupancy, kept up to date as snakes, fruits and obstacles move.
+    // Dead snakes are removed from snakeCells.
+    Bitboard snakeCells;
+    Bitboard obstacleCells;
+    Bitboard foodCells;
+
+    // Cells not covered by any of the above, as an index-addressable set:
+    // freeCells[0..freeCount) lists them in no particular order and
+    // freeSlot[cell] is the cell's position in that list, -1 if taken
+    int *freeCells;
+    int *freeSlot;
+    int freeCount;
+
+    // freeCells positions written since the last reset. reset_game() puts
+    // just those back in cell order, so every match starts from the same
+    // free set whatever the previous one did.
+    Bitboard movedSlots;
+
+    // Cells whose contents changed since clear_dirty_cells(), so a renderer
+    // can repaint just those. Past MAX_DIRTY_CELLS (and after a reset) only
+    // dirtyOverflow is set: treat the whole board as changed. A cell may be
+    // listed more than once.
+    int dirtyCells[MAX_DIRTY_CELLS];
+    int dirtyCount;
+    bool dirtyOverflow;
+
+    // Bumped by reset_game(). The board size and the static obstacles only
+    // change when it does, so a renderer can cache them until then.
+    unsigned layout;
+
+    bool timed;
+    int timeLimit;      // Match length in milliseconds, 0 if untimed
+    int updateDelay;    // Milliseconds per tick
+
+    unsigned tick;      // Ticks simulated since reset_game()
+    unsigned elapsed;   // Simulated milliseconds since reset_game()
+    bool over;
+
+    char modeName[50]; // Name of the current mode configuration
+
+    Rng rng;      // Source of all randomness in the game, see seed_game()
+    Rng matchRng; // rng as reset_game() found it; replays start from here
+} Game;
+
+static inline int cell_index(const Game *game, int x, int y) {
+    return y * game->width + x;
+}
+
+// Setup. configure_game() sets up a width x height board and reserves the
+// match arena, returning false if the size is out of range or the
+// allocation fails; it may be called again on the same Game to switch modes.
+// free_game() releases the arena.
+bool configure_game(Game *game, GameMode mode, const GameFeatures *features, int width, int height);
+void reset_game(Game *game);
+void free_game(Game *game);
+
+// Seed the game's random number generator. The state survives
+// configure_game() and reset_game(), so matches carry on the sequence;
+// seeding before reset_game() makes the next match reproducible: the same
+// seed and the same inputs tick for tick give a bit-identical game. A game
+// that was never seeded starts as if seeded with 0.
+void seed_game(Game *game, uint64_t seed);
+void generate_mode_name(Game *game, const GameFeatures *features);
+
+// Snapshots. Every pointer in a Game leads into its arena, so a struct copy
+// shares the board and the snake bodies with the original and stepping one
+// corrupts the other. copy_game() makes `copy` an independent copy of
+// `game` instead, arena, rng and matchRng included, reusing the arena
+// `copy` already has when it is big enough. Save with
+//     copy_game(&snapshot, &game)
+// and go back with copy_game(&game, &snapshot): stepping the game from
+// there with the same inputs replays it exactly. Returns false, leaving
+// `copy` as it was, if the allocation fails. Free a snapshot with
+// free_game().
+bool copy_game(Game *copy, const Game *game);
+
+// Simulation
+GameEvents step_game(Game *game, const GameInput *input);
+void turn_snake(Snake *snake, Direction dir);
+bool move_snake(Game *game, int index);
+void kill_snake(Game *game, int index);
+void grow_snake(Snake *snake);
+bool check_food_collision(const Snake *snake, const Food *food);
+bool check_obstacle_collision(const Game *game, const Snake *snake);
+bool place_food(Game *game, Food *food);
+void remove_food(Game *game, Food *food);
+void place_obstacles(Game *game);
+void initialize_multi_fruits(Game *game);
+bool ensure_minimum_fruits(Game *game);
+void move_foods(Game *game);
+void move_obstacles(Game *game);
+void update_game(Game *game);
+
+// Renderer support
+void clear_dirty_cells(Game *game);
+
+// Queries
+int get_time_left(const Game *game);
+bool is_cell_free(const Game *game, int x, int y);
+
+#endif
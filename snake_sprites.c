@@ -0,0 +1,128 @@
+#include "snake_sprites.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SPRITE_CIRCLE 0
+#define SPRITE_EYES 1
+
+static const SDL_Color SPRITE_WHITE = {255, 255, 255, 255};
+
+// Set the pixels the old drawCircle(x, y, radius) plotted, with (cx, cy)
+// the centre relative to the sprite at column `left` of the texture
+static void fill_circle(Uint8 *pixels, int pitch, int left, int size, int cx, int cy, int radius,
+                        Uint8 r, Uint8 g, Uint8 b) {
+    for (int w = 0; w < radius * 2; w++) {
+        for (int h = 0; h < radius * 2; h++) {
+            int dx = radius - w;
+            int dy = radius - h;
+            if (dx * dx + dy * dy > radius * radius) continue;
+
+            int x = cx + dx, y = cy + dy;
+            if (x < 0 || y < 0 || x >= size || y >= size) continue;
+
+            Uint8 *pixel = pixels + y * pitch + (left + x) * 4;
+            pixel[0] = r;
+            pixel[1] = g;
+            pixel[2] = b;
+            pixel[3] = 255;
+        }
+    }
+}
+
+// Rebuild the texture for the view's cell size if it changed
+static bool prepare_sprites(RenderQueue *queue, SnakeSprites *sprites, const BoardView *view) {
+    if (sprites->cellSize == view->cellSize) return sprites->texture != NULL;
+
+    // The old texture may still be waiting in the queue
+    if (sprites->texture) {
+        flush_render_queue(queue);
+        SDL_DestroyTexture(sprites->texture);
+    }
+    sprites->texture = NULL;
+    sprites->cellSize = view->cellSize;
+    sprites->radius = view->cellSize / 2;
+
+    int radius = sprites->radius;
+    int size = radius * 2;
+    if (size == 0) return false;
+
+    int pitch = size * 2 * 4;
+    Uint8 *pixels = calloc((size_t)pitch * size, 1);
+    if (!pixels) return false;
+
+    // The circle sits one pixel in from the cell corner, so its centre
+    // (cell corner + radius on screen) is at radius - 1 in the sprite
+    int centre = radius - 1;
+    fill_circle(pixels, pitch, 0, size, centre, centre, radius, 255, 255, 255);
+
+    // Eyes and pupils, placed relative to the head centre as before
+    int eye_offset_x = radius / 2;
+    int eye_offset_y = radius / 3;
+    int eye_radius = radius / 4;
+    int pupil_radius = eye_radius / 2;
+    int eye_y = centre - eye_offset_y;
+    fill_circle(pixels, pitch, size, size, centre - eye_offset_x, eye_y, eye_radius, 255, 255, 255);
+    fill_circle(pixels, pitch, size, size, centre + eye_offset_x, eye_y, eye_radius, 255, 255, 255);
+    fill_circle(pixels, pitch, size, size, centre - eye_offset_x, eye_y, pupil_radius, 0, 0, 0);
+    fill_circle(pixels, pitch, size, size, centre + eye_offset_x, eye_y, pupil_radius, 0, 0, 0);
+
+    sprites->texture = SDL_CreateTexture(queue->renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC,
+                                         size * 2, size);
+    if (sprites->texture) {
+        SDL_UpdateTexture(sprites->texture, NULL, pixels, pitch);
+        SDL_SetTextureBlendMode(sprites->texture, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureScaleMode(sprites->texture, SDL_ScaleModeNearest);
+    } else {
+        printf("Failed to create snake sprites! SDL_Error: %s\n", SDL_GetError());
+    }
+
+    free(pixels);
+    return sprites->texture != NULL;
+}
+
+// Queue one sprite over cell (x, y)
+static void queue_sprite(RenderQueue *queue, const SnakeSprites *sprites, const BoardView *view,
+                         int x, int y, int sprite, SDL_Color color) {
+    int size = sprites->radius * 2;
+    SDL_Rect rect = {view_screen_x(view, x) + 1, view_screen_y(view, y) + 1, size, size};
+    SDL_FRect uv = {sprite * 0.5f, 0, 0.5f, 1};
+    queue_quad(queue, sprites->texture, &rect, uv, color);
+}
+
+void draw_snake_sprites(RenderQueue *queue, SnakeSprites *sprites, const BoardView *view,
+                        const Snake *snake, SDL_Color body, SDL_Color head) {
+    if (!prepare_sprites(queue, sprites, view)) return;
+
+    set_queue_layer(queue, LAYER_SNAKE);
+    for (int i = 1; i < snake->length; i++) {
+        const Segment *segment = snake_segment(snake, i);
+        if (!view_contains(view, segment->x, segment->y)) continue;
+        queue_sprite(queue, sprites, view, segment->x, segment->y, SPRITE_CIRCLE, body);
+    }
+    draw_head_sprite(queue, sprites, view, snake, head);
+}
+
+void draw_body_sprite(RenderQueue *queue, SnakeSprites *sprites, const BoardView *view,
+                      int x, int y, SDL_Color color) {
+    if (!prepare_sprites(queue, sprites, view)) return;
+
+    set_queue_layer(queue, LAYER_SNAKE);
+    queue_sprite(queue, sprites, view, x, y, SPRITE_CIRCLE, color);
+}
+
+void draw_head_sprite(RenderQueue *queue, SnakeSprites *sprites, const BoardView *view,
+                      const Snake *snake, SDL_Color color) {
+    const Segment *head = snake_head(snake);
+    if (!view_contains(view, head->x, head->y) || !prepare_sprites(queue, sprites, view)) return;
+
+    set_queue_layer(queue, LAYER_SNAKE);
+    queue_sprite(queue, sprites, view, head->x, head->y, SPRITE_CIRCLE, color);
+    queue_sprite(queue, sprites, view, head->x, head->y, SPRITE_EYES, SPRITE_WHITE);
+}
+
+void free_snake_sprites(SnakeSprites *sprites) {
+    if (sprites->texture) SDL_DestroyTexture(sprites->texture);
+    sprites->texture = NULL;
+    sprites->cellSize = 0;
+}
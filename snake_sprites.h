@@ -0,0 +1,40 @@
+#ifndef SNAKE_SPRITES_H
+#define SNAKE_SPRITES_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+#include "board_view.h"
+#include "render_queue.h"
+
+// Snake drawing shared by the front-ends. The body circle and the eyes are
+// rasterized once per cell size into a small texture, pixel for pixel as
+// the old point-by-point circle drawing produced them, and a snake is then
+// queued as textured quads on LAYER_SNAKE, which the queue submits in one
+// SDL_RenderGeometry call. The circle is white and takes its colour from
+// the vertices, so one texture serves every snake.
+//
+// A circle covers the cellSize - 1 pixels after its cell's top-left corner
+// plus one more, so it overlaps the grid line of the cells to its right and
+// below when cellSize is even.
+
+typedef struct {
+    int cellSize;          // Size the texture was built for, 0 if none
+    int radius;
+    SDL_Texture *texture;  // Circle mask, then the eyes, side by side
+} SnakeSprites;
+
+// Body segments in `body`, then the head in `head` with its eyes on top.
+// Builds or rebuilds the texture when the view's cell size has changed.
+void draw_snake_sprites(RenderQueue *queue, SnakeSprites *sprites, const BoardView *view,
+                        const Snake *snake, SDL_Color body, SDL_Color head);
+
+// A single body circle or head, for repainting one cell
+void draw_body_sprite(RenderQueue *queue, SnakeSprites *sprites, const BoardView *view,
+                      int x, int y, SDL_Color color);
+void draw_head_sprite(RenderQueue *queue, SnakeSprites *sprites, const BoardView *view,
+                      const Snake *snake, SDL_Color color);
+
+void free_snake_sprites(SnakeSprites *sprites);
+
+#endif
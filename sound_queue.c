@@ -0,0 +1,129 @@
+#ifndef SNAKE_HEADLESS
+
+#include "sound_queue.h"
+
+#include <SDL2/SDL_mixer.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "metrics.h"
+#include "trace.h"
+
+// Runs on the audio thread after SDL_mixer has mixed its own channels
+// into `stream`, which holds 16-bit samples in the device's channel layout
+static void mix_sounds(void *data, Uint8 *stream, int length) {
+    SoundQueue *queue = data;
+    TRACE_BEGIN(mixing);
+    Uint64 now = SDL_GetPerformanceCounter();
+    double frequency = (double)SDL_GetPerformanceFrequency();
+
+    // A buffer mixed more than two buffers' playing time after the last
+    // one has most likely left the device with nothing to play
+    if (queue->lastMix != 0 && queue->bufferCounts != 0 && now - queue->lastMix > 2 * queue->bufferCounts) {
+        count_audio_underrun();
+    }
+    queue->lastMix = now;
+
+    // Start a voice for every event posted since the last buffer
+    int tail = SDL_AtomicGet(&queue->tail);
+    int head = SDL_AtomicGet(&queue->head);
+    SDL_MemoryBarrierAcquire();
+    for (; tail != head; tail++) {
+        const SoundEvent *event = &queue->events[tail & (SOUND_QUEUE_SIZE - 1)];
+
+        // A free voice, or else the one furthest along
+        Voice *voice = &queue->voices[0];
+        for (int i = 0; i < MAX_VOICES && voice->chunk; i++) {
+            Voice *candidate = &queue->voices[i];
+            if (!candidate->chunk || candidate->position > voice->position) voice = candidate;
+        }
+        voice->chunk = event->chunk;
+        voice->position = 0;
+
+        if (queue->measure) {
+            double latency = (now - event->posted) * 1000.0 / frequency;
+            queue->latencySum += latency;
+            if (latency > queue->latencyWorst) queue->latencyWorst = latency;
+            queue->sounds++;
+        }
+    }
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&queue->tail, tail);
+
+    Sint16 *out = (Sint16 *)stream;
+    int samples = length / (int)sizeof(Sint16);
+
+    for (int v = 0; v < MAX_VOICES; v++) {
+        Voice *voice = &queue->voices[v];
+        if (!voice->chunk) continue;
+
+        const Mix_Chunk *chunk = (const Mix_Chunk *)voice->chunk;
+        const Sint16 *in = (const Sint16 *)(chunk->abuf + voice->position);
+        int left = (int)((chunk->alen - voice->position) / sizeof(Sint16));
+        int count = left < samples ? left : samples;
+
+        for (int i = 0; i < count; i++) {
+            int mixed = out[i] + in[i] * chunk->volume / MIX_MAX_VOLUME;
+            if (mixed > 32767) mixed = 32767;
+            if (mixed < -32768) mixed = -32768;
+            out[i] = (Sint16)mixed;
+        }
+
+        voice->position += (Uint32)count * sizeof(Sint16);
+        if (count == left) voice->chunk = NULL;
+    }
+    TRACE_END(mixing, "mix_sounds");
+}
+
+void start_sound_queue(SoundQueue *queue, int bufferSamples, bool measure) {
+    memset(queue, 0, sizeof(SoundQueue));
+    queue->measure = measure;
+    queue->bufferSamples = bufferSamples;
+
+    int frequency = 0;
+    Mix_QuerySpec(&frequency, NULL, NULL);
+    if (frequency > 0) {
+        queue->bufferCounts = (Uint64)bufferSamples * SDL_GetPerformanceFrequency() / (Uint64)frequency;
+    }
+    Mix_SetPostMix(mix_sounds, queue);
+}
+
+void stop_sound_queue(SoundQueue *queue) {
+    // Mix_SetPostMix() locks the device, so the callback isn't running
+    // once it returns
+    Mix_SetPostMix(NULL, NULL);
+
+    if (queue->measure) {
+        int frequency = 0;
+        Mix_QuerySpec(&frequency, NULL, NULL);
+        printf("audio: %ld sounds, event to mixer %.2f ms mean, %.2f ms worst, %d dropped",
+               queue->sounds, queue->sounds > 0 ? queue->latencySum / queue->sounds : 0.0,
+               queue->latencyWorst, SDL_AtomicGet(&queue->dropped));
+        if (frequency > 0) {
+            printf("; the %d-sample buffer adds up to %.1f ms more",
+                   queue->bufferSamples, queue->bufferSamples * 1000.0 / frequency);
+        }
+        printf("\n");
+    }
+    memset(queue->voices, 0, sizeof(queue->voices));
+}
+
+void play_sound(SoundQueue *queue, const struct Mix_Chunk *chunk) {
+    if (!chunk) return;
+
+    int head = SDL_AtomicGet(&queue->head);
+    if (head - SDL_AtomicGet(&queue->tail) == SOUND_QUEUE_SIZE) {
+        SDL_AtomicAdd(&queue->dropped, 1);
+        return;
+    }
+
+    SoundEvent *event = &queue->events[head & (SOUND_QUEUE_SIZE - 1)];
+    event->chunk = chunk;
+    event->posted = SDL_GetPerformanceCounter();
+
+    // Publish the event before the new head
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&queue->head, head + 1);
+}
+
+#endif
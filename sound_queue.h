@@ -0,0 +1,91 @@
+#ifndef SOUND_QUEUE_H
+#define SOUND_QUEUE_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+// Sound effects without touching the mixer from the game loop. play_sound()
+// only writes an event into a single-producer, single-consumer ring; the
+// mixer's audio thread drains the ring at the start of every buffer it
+// fills and mixes the sounds in itself, from a post-mix callback. Nothing
+// on either side takes a lock, so a tick never waits on the audio device,
+// and a sound starts in the first buffer mixed after it was posted.
+//
+// Sounds are Mix_Chunks loaded for the open mixer, so already in its
+// format, which the host opens as 16-bit. They must stay loaded until the
+// queue is stopped.
+//
+// Built with SNAKE_HEADLESS the queue is empty and play_sound() does
+// nothing; with the host's mixer compiled out too (see host.h), headless
+// builds need neither SDL_mixer nor an audio thread.
+
+#define SOUND_QUEUE_SIZE 64  // Events in flight; a power of two
+#define MAX_VOICES 8         // Sounds playing at once
+
+struct Mix_Chunk;
+
+#ifndef SNAKE_HEADLESS
+
+typedef struct {
+    const struct Mix_Chunk *chunk;
+    Uint64 posted;  // Performance counter when play_sound() was called
+} SoundEvent;
+
+typedef struct {
+    const struct Mix_Chunk *chunk;  // NULL when the voice is free
+    Uint32 position;                // Bytes already mixed
+} Voice;
+
+typedef struct {
+    // The ring: the game thread writes `head`, the audio thread `tail`
+    SoundEvent events[SOUND_QUEUE_SIZE];
+    SDL_atomic_t head, tail;
+    SDL_atomic_t dropped;  // Events lost to a full ring
+
+    // Audio thread only
+    Voice voices[MAX_VOICES];
+    Uint64 lastMix;       // Performance counter at the last buffer
+    Uint64 bufferCounts;  // A buffer's playing time, in counter units
+
+    // Event to mixer callback latency (--measure-audio), written by the
+    // audio thread and read once it has stopped
+    bool measure;
+    int bufferSamples;
+    long sounds;
+    double latencySum, latencyWorst;  // In ms
+} SoundQueue;
+
+// Hook into the mixer opened with `bufferSamples` samples per buffer
+void start_sound_queue(SoundQueue *queue, int bufferSamples, bool measure);
+
+// Unhook and, if measuring, print the latency seen. Sounds still playing
+// are cut off.
+void stop_sound_queue(SoundQueue *queue);
+
+// Start `chunk` playing; a NULL chunk is ignored
+void play_sound(SoundQueue *queue, const struct Mix_Chunk *chunk);
+
+#else
+
+typedef struct {
+    int unused;
+} SoundQueue;
+
+static inline void start_sound_queue(SoundQueue *queue, int bufferSamples, bool measure) {
+    (void)queue;
+    (void)bufferSamples;
+    (void)measure;
+}
+
+static inline void stop_sound_queue(SoundQueue *queue) {
+    (void)queue;
+}
+
+static inline void play_sound(SoundQueue *queue, const struct Mix_Chunk *chunk) {
+    (void)queue;
+    (void)chunk;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,211 @@
+#include "text.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define ATLAS_WIDTH 512
+
+static const SDL_Color ATLAS_WHITE = {255, 255, 255, 255};
+
+static const Glyph *find_glyph(const Font *font, char c) {
+    unsigned char code = (unsigned char)c;
+    if (code < FONT_FIRST_GLYPH || code > FONT_LAST_GLYPH) code = '?';
+    return &font->glyphs[code - FONT_FIRST_GLYPH];
+}
+
+// Rasterize every glyph in white, shelf-pack them into one surface and
+// upload it. Colour comes from the vertices at draw time.
+static bool build_atlas(Font *font, SDL_Renderer *renderer) {
+    SDL_Surface *surfaces[FONT_GLYPHS] = {0};
+    int x = 0, y = 0, row_height = 0;
+    bool ok = true;
+
+    for (int i = 0; i < FONT_GLYPHS; i++) {
+        Uint16 code = (Uint16)(FONT_FIRST_GLYPH + i);
+        Glyph *glyph = &font->glyphs[i];
+
+        int advance = 0;
+        TTF_GlyphMetrics(font->ttf, code, NULL, NULL, NULL, NULL, &advance);
+        glyph->advance = advance;
+
+        // Blank glyphs (the space) may come back as NULL; they only advance
+        surfaces[i] = font->smooth ? TTF_RenderGlyph_Blended(font->ttf, code, ATLAS_WHITE)
+                                   : TTF_RenderGlyph_Solid(font->ttf, code, ATLAS_WHITE);
+        if (!surfaces[i] || surfaces[i]->w == 0) continue;
+
+        if (x + surfaces[i]->w > ATLAS_WIDTH) {
+            x = 0;
+            y += row_height + 1;
+            row_height = 0;
+        }
+        glyph->source = (SDL_Rect){x, y, surfaces[i]->w, surfaces[i]->h};
+        x += surfaces[i]->w + 1; // One pixel gap so filtering never bleeds
+        if (surfaces[i]->h > row_height) row_height = surfaces[i]->h;
+    }
+
+    font->atlasWidth = ATLAS_WIDTH;
+    font->atlasHeight = y + row_height;
+
+    SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(0, font->atlasWidth, font->atlasHeight,
+                                                        32, SDL_PIXELFORMAT_RGBA32);
+    ok = atlas != NULL;
+
+    for (int i = 0; ok && i < FONT_GLYPHS; i++) {
+        if (!surfaces[i] || font->glyphs[i].source.w == 0) continue;
+
+        // Copy the coverage as is rather than blending it onto the clear atlas
+        SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+        ok = SDL_BlitSurface(surfaces[i], NULL, atlas, &font->glyphs[i].source) == 0;
+    }
+
+    if (ok) {
+        font->atlas = SDL_CreateTextureFromSurface(renderer, atlas);
+        ok = font->atlas != NULL;
+    }
+    if (ok) SDL_SetTextureBlendMode(font->atlas, SDL_BLENDMODE_BLEND);
+
+    for (int i = 0; i < FONT_GLYPHS; i++) {
+        SDL_FreeSurface(surfaces[i]);
+    }
+    SDL_FreeSurface(atlas);
+    return ok;
+}
+
+Font *open_font(SDL_Renderer *renderer, const char *path, int size, bool smooth) {
+    return open_font_rw(renderer, SDL_RWFromFile(path, "rb"), size, smooth);
+}
+
+Font *open_font_rw(SDL_Renderer *renderer, SDL_RWops *source, int size, bool smooth) {
+    Font *font = calloc(1, sizeof(Font));
+    if (!font) {
+        if (source) SDL_RWclose(source);
+        return NULL;
+    }
+
+    font->ttf = TTF_OpenFontRW(source, 1, size);
+    font->smooth = smooth;
+    if (!font->ttf || !build_atlas(font, renderer)) {
+        close_font(font);
+        return NULL;
+    }
+    font->height = TTF_FontHeight(font->ttf);
+    return font;
+}
+
+void close_font(Font *font) {
+    if (!font) return;
+
+    for (int i = 0; i < LABEL_CACHE_SIZE; i++) {
+        if (font->labels[i].texture) SDL_DestroyTexture(font->labels[i].texture);
+    }
+    if (font->atlas) SDL_DestroyTexture(font->atlas);
+    if (font->ttf) TTF_CloseFont(font->ttf);
+    free(font);
+}
+
+void text_size(const Font *font, const char *text, int *width, int *height) {
+    int w = 0;
+    for (const char *c = text; *c; c++) {
+        w += find_glyph(font, *c)->advance;
+    }
+    if (width) *width = w;
+    if (height) *height = font->height;
+}
+
+// --- Atlas drawing ---
+
+void draw_text(RenderQueue *queue, Font *font, const char *text, int x, int y, SDL_Color color) {
+    float scale_u = 1.0f / font->atlasWidth;
+    float scale_v = 1.0f / font->atlasHeight;
+
+    set_queue_layer(queue, LAYER_TEXT);
+    for (const char *c = text; *c; c++) {
+        const Glyph *glyph = find_glyph(font, *c);
+        const SDL_Rect *src = &glyph->source;
+
+        if (src->w > 0) {
+            SDL_Rect rect = {x, y, src->w, src->h};
+            SDL_FRect uv = {src->x * scale_u, src->y * scale_v, src->w * scale_u, src->h * scale_v};
+            queue_quad(queue, font->atlas, &rect, uv, color);
+        }
+        x += glyph->advance;
+    }
+}
+
+void draw_text_centered(RenderQueue *queue, Font *font, const char *text, int x, int y, SDL_Color color) {
+    int width, height;
+    text_size(font, text, &width, &height);
+    draw_text(queue, font, text, x - width / 2, y - height / 2, color);
+}
+
+// --- Label cache ---
+
+static bool same_color(SDL_Color a, SDL_Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+// Find the cached texture for text/color, rendering it into the least
+// recently used slot on a miss. Returns NULL if it cannot be cached.
+static Label *find_label(RenderQueue *queue, Font *font, const char *text, SDL_Color color) {
+    if (strlen(text) >= MAX_LABEL_LENGTH) return NULL;
+
+    font->clock++;
+    Label *oldest = &font->labels[0];
+    for (int i = 0; i < LABEL_CACHE_SIZE; i++) {
+        Label *label = &font->labels[i];
+        if (label->texture && same_color(label->color, color) && strcmp(label->text, text) == 0) {
+            label->lastUsed = font->clock;
+            font->labelHits++;
+            return label;
+        }
+        if (!label->texture || (oldest->texture && label->lastUsed < oldest->lastUsed)) {
+            oldest = label;
+        }
+    }
+
+    font->labelMisses++;
+    SDL_Surface *surface = font->smooth ? TTF_RenderText_Blended(font->ttf, text, color)
+                                        : TTF_RenderText_Solid(font->ttf, text, color);
+    if (!surface) return NULL;
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(queue->renderer, surface);
+    int width = surface->w, height = surface->h;
+    SDL_FreeSurface(surface);
+    if (!texture) return NULL;
+
+    // The evicted texture may still be waiting in the queue
+    if (oldest->texture) {
+        flush_render_queue(queue);
+        SDL_DestroyTexture(oldest->texture);
+    }
+    strcpy(oldest->text, text);
+    oldest->color = color;
+    oldest->texture = texture;
+    oldest->width = width;
+    oldest->height = height;
+    oldest->lastUsed = font->clock;
+    return oldest;
+}
+
+void draw_label(RenderQueue *queue, Font *font, const char *text, int x, int y, SDL_Color color) {
+    Label *label = find_label(queue, font, text, color);
+    if (!label) {
+        draw_text(queue, font, text, x, y, color);
+        return;
+    }
+
+    SDL_Rect rect = {x, y, label->width, label->height};
+    set_queue_layer(queue, LAYER_TEXT);
+    queue_copy(queue, label->texture, NULL, &rect);
+}
+
+void draw_label_centered(RenderQueue *queue, Font *font, const char *text, int x, int y, SDL_Color color) {
+    Label *label = find_label(queue, font, text, color);
+    if (!label) {
+        draw_text_centered(queue, font, text, x, y, color);
+        return;
+    }
+
+    SDL_Rect rect = {x - label->width / 2, y - label->height / 2, label->width, label->height};
+    set_queue_layer(queue, LAYER_TEXT);
+    queue_copy(queue, label->texture, NULL, &rect);
+}
@@ -0,0 +1,74 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdbool.h>
+
+#include "render_queue.h"
+
+// Text drawing shared by the front-ends. A font's printable ASCII glyphs are
+// rasterized once into a texture atlas; draw_text() then lays strings out
+// from the glyph advances and queues them as textured quads on LAYER_TEXT,
+// so per-frame text (scores, timers) never goes back to SDL_ttf.
+//
+// Labels that stay the same for many frames (titles, buttons) can use
+// draw_label() instead, which renders the whole string through SDL_ttf with
+// proper kerning and keeps the texture in a small LRU cache.
+
+#define FONT_FIRST_GLYPH 32  // ' '
+#define FONT_LAST_GLYPH 126  // '~'
+#define FONT_GLYPHS (FONT_LAST_GLYPH - FONT_FIRST_GLYPH + 1)
+
+#define LABEL_CACHE_SIZE 32
+#define MAX_LABEL_LENGTH 64  // Longer strings fall back to the atlas
+
+typedef struct {
+    SDL_Rect source;  // Position in the atlas; empty for blank glyphs
+    int advance;      // Pen movement in pixels
+} Glyph;
+
+typedef struct {
+    char text[MAX_LABEL_LENGTH];
+    SDL_Color color;
+    SDL_Texture *texture;  // NULL while the slot is free
+    int width, height;
+    unsigned lastUsed;
+} Label;
+
+typedef struct {
+    TTF_Font *ttf;
+    bool smooth;          // Blended (anti-aliased) rather than Solid rendering
+    int height;           // Line height in pixels
+
+    SDL_Texture *atlas;
+    int atlasWidth, atlasHeight;
+    Glyph glyphs[FONT_GLYPHS];
+
+    Label labels[LABEL_CACHE_SIZE];
+    unsigned clock;       // Advances on every label lookup
+    unsigned labelHits, labelMisses;
+} Font;
+
+// Open a TrueType font at `size` points and build its atlas for `renderer`.
+// Returns NULL on failure (see TTF_GetError()/SDL_GetError()).
+Font *open_font(SDL_Renderer *renderer, const char *path, int size, bool smooth);
+
+// The same from a font file in memory or anywhere else SDL can read.
+// Takes ownership of `source`, which may be NULL after a failed open.
+Font *open_font_rw(SDL_Renderer *renderer, SDL_RWops *source, int size, bool smooth);
+void close_font(Font *font);
+
+// Size of `text` as draw_text() would lay it out. Uses the glyph metrics
+// only, so it is cheap and touches neither SDL_ttf nor the GPU.
+void text_size(const Font *font, const char *text, int *width, int *height);
+
+// Draw from the atlas with (x, y) the top-left corner or the centre
+void draw_text(RenderQueue *queue, Font *font, const char *text, int x, int y, SDL_Color color);
+void draw_text_centered(RenderQueue *queue, Font *font, const char *text, int x, int y, SDL_Color color);
+
+// Draw through the label cache, for strings that rarely change
+void draw_label(RenderQueue *queue, Font *font, const char *text, int x, int y, SDL_Color color);
+void draw_label_centered(RenderQueue *queue, Font *font, const char *text, int x, int y, SDL_Color color);
+
+#endif
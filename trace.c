@@ -0,0 +1,145 @@
+#ifdef SNAKE_TRACE
+
+#include "trace.h"
+
+#include <SDL2/SDL.h>
+#include <stdlib.h>
+
+typedef struct {
+    const char *name;  // A string literal
+    uint64_t start, end;
+} TraceSpan;
+
+// One thread's spans. Only its thread writes to it; `count` is published
+// after each span so a dump from another thread sees whole ones.
+typedef struct TraceBuffer {
+    TraceSpan spans[TRACE_BUFFER_SIZE];
+    SDL_atomic_t count;  // Spans ever recorded; the ring holds the last ones
+    unsigned long thread;
+    char name[32];
+    struct TraceBuffer *next;
+} TraceBuffer;
+
+bool traceEnabled = false;
+
+static const char *tracePath;
+static SDL_TLSID bufferKey;
+static SDL_SpinLock listLock;
+static TraceBuffer *buffers;
+static uint64_t origin;  // Counter when tracing started
+
+// The calling thread's buffer, made on its first span
+static TraceBuffer *thread_buffer(void) {
+    TraceBuffer *buffer = SDL_TLSGet(bufferKey);
+    if (buffer) return buffer;
+
+    buffer = calloc(1, sizeof(TraceBuffer));
+    if (!buffer) return NULL;
+    buffer->thread = SDL_ThreadID();
+    snprintf(buffer->name, sizeof(buffer->name), "thread %lu", buffer->thread);
+
+    SDL_AtomicLock(&listLock);
+    buffer->next = buffers;
+    buffers = buffer;
+    SDL_AtomicUnlock(&listLock);
+
+    SDL_TLSSet(bufferKey, buffer, NULL);
+    return buffer;
+}
+
+uint64_t trace_now(void) {
+    return SDL_GetPerformanceCounter();
+}
+
+void trace_span(const char *name, uint64_t start) {
+    uint64_t end = SDL_GetPerformanceCounter();
+    TraceBuffer *buffer = thread_buffer();
+    if (!buffer) return;
+
+    int count = SDL_AtomicGet(&buffer->count);
+    TraceSpan *span = &buffer->spans[(unsigned)count & (TRACE_BUFFER_SIZE - 1)];
+    span->name = name;
+    span->start = start;
+    span->end = end;
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&buffer->count, (int)((unsigned)count + 1));
+}
+
+void start_trace(const char *path) {
+    tracePath = path;
+    bufferKey = SDL_TLSCreate();
+    origin = SDL_GetPerformanceCounter();
+    trace_thread_name("main");
+    traceEnabled = true;
+}
+
+void trace_thread_name(const char *name) {
+    TraceBuffer *buffer = thread_buffer();
+    if (buffer) snprintf(buffer->name, sizeof(buffer->name), "%s", name);
+}
+
+bool dump_trace(void) {
+    if (!tracePath) return false;
+
+    FILE *file = fopen(tracePath, "w");
+    if (!file) {
+        printf("%s: cannot write\n", tracePath);
+        return false;
+    }
+
+    // Timestamps in microseconds since tracing started
+    double scale = 1e6 / SDL_GetPerformanceFrequency();
+    long written = 0;
+    bool first = true;
+
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    SDL_AtomicLock(&listLock);
+    for (TraceBuffer *buffer = buffers; buffer; buffer = buffer->next) {
+        fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %lu, "
+                      "\"args\": {\"name\": \"%s\"}}",
+                first ? "" : ",\n", buffer->thread, buffer->name);
+        first = false;
+
+        unsigned count = (unsigned)SDL_AtomicGet(&buffer->count);
+        SDL_MemoryBarrierAcquire();
+        unsigned oldest = count > TRACE_BUFFER_SIZE ? count - TRACE_BUFFER_SIZE : 0;
+        for (unsigned i = oldest; i != count; i++) {
+            const TraceSpan *span = &buffer->spans[i & (TRACE_BUFFER_SIZE - 1)];
+            if (span->start < origin) continue;  // Begun before tracing was on
+            fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %lu, "
+                          "\"ts\": %.3f, \"dur\": %.3f}",
+                    span->name, buffer->thread, (span->start - origin) * scale,
+                    (span->end - span->start) * scale);
+            written++;
+        }
+    }
+    SDL_AtomicUnlock(&listLock);
+    fprintf(file, "\n]}\n");
+
+    bool ok = fclose(file) == 0;
+    if (ok) {
+        printf("trace: %ld spans written to %s\n", written, tracePath);
+    } else {
+        printf("%s: write failed\n", tracePath);
+    }
+    return ok;
+}
+
+void stop_trace(void) {
+    if (!traceEnabled) return;
+
+    dump_trace();
+    traceEnabled = false;
+
+    SDL_AtomicLock(&listLock);
+    while (buffers) {
+        TraceBuffer *next = buffers->next;
+        free(buffers);
+        buffers = next;
+    }
+    SDL_AtomicUnlock(&listLock);
+    SDL_TLSSet(bufferKey, NULL, NULL);
+}
+
+#endif
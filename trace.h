@@ -0,0 +1,74 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Timeline tracing for --trace FILE. Code marks spans with
+//
+//     TRACE_BEGIN(span);
+//     update_game(game);
+//     TRACE_END(span, "update_game");
+//
+// and every thread records its spans into a ring buffer of its own, which
+// keeps the last TRACE_BUFFER_SIZE of them. dump_trace() writes all rings
+// as Chrome trace event JSON (chrome://tracing, Perfetto), on F9 in the
+// game and when it exits, so a session shows where every frame went.
+//
+// Built with SNAKE_TRACE defined, a span costs one well-predicted branch
+// at each end while tracing is off. Without it the macros are empty and
+// the functions do nothing, so tools that build snake_sim.c alone don't
+// need trace.c or SDL.
+
+#define TRACE_BUFFER_SIZE 65536  // Spans kept per thread; a power of two
+
+#ifdef SNAKE_TRACE
+
+extern bool traceEnabled;
+
+// Performance counter now, and record a span from `start` to now
+uint64_t trace_now(void);
+void trace_span(const char *name, uint64_t start);
+
+#define TRACE_BEGIN(span) uint64_t span = traceEnabled ? trace_now() : 0
+#define TRACE_END(span, name) do { if (traceEnabled) trace_span(name, span); } while (0)
+
+// Start recording, to be written to `path`. Call once, from the main
+// thread, outside any span.
+void start_trace(const char *path);
+
+// Name the calling thread in the trace (the main thread is "main")
+void trace_thread_name(const char *name);
+
+// Write everything recorded so far. Spans other threads are recording
+// while this runs may come out garbled. Prints a message and returns false
+// if the file can't be written.
+bool dump_trace(void);
+
+// Dump and stop, once no other thread records any more
+void stop_trace(void);
+
+#else
+
+#define TRACE_BEGIN(span)
+#define TRACE_END(span, name)
+
+static inline void start_trace(const char *path) {
+    printf("%s: not traced, this build was made without SNAKE_TRACE\n", path);
+}
+
+static inline void trace_thread_name(const char *name) {
+    (void)name;
+}
+
+static inline bool dump_trace(void) {
+    return false;
+}
+
+static inline void stop_trace(void) {
+}
+
+#endif
+
+#endif